@@ -0,0 +1,1260 @@
+//////////////////////////////////////////////////////////////
+// cio-convert: command-line tool converting integer        //
+// values between enumeration bases and scalar types.       //
+//                                                          //
+// Input numbers are whitespace separated tokens, the       //
+// whitespace between them is copied to output as is, so    //
+// line structure of input is kept.                         //
+//////////////////////////////////////////////////////////////
+#include "consoleio.h"
+#include "consoleio_agg.h"
+#include "consoleio_sort.h"
+#include "consoleio_dump.h"
+#include "consoleio_cpu.h"
+#include "consoleio_col.h"
+#include <string>
+#include <sstream>
+#include <streambuf>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+//////////////////////////////////////////////////////
+// Module global namespace                          //
+//////////////////////////////////////////////////////
+using namespace std;
+
+//////////////////////////////////////////////////////
+// Module global macros                             //
+//////////////////////////////////////////////////////
+// Tool name for messages
+#define TOOL_NAME "cio-convert"
+
+// Size of input block converted by one thread
+#define BLOCK_SIZE      (1 << 20)
+
+// Default size of output buffer
+#define OUT_BUF_DFLT    (1 << 20)
+
+// Extension of output files in batch mode
+#define BATCH_EXT       ".out"
+
+// Maximal number of reported invalid tokens
+#define ERR_REPORT_MAX  10
+
+// Maximal number of conversion threads
+#define THREADS_MAX     256
+
+// Maximal number of raw values per line
+#define PER_LINE_MAX    4096
+
+//////////////////////////////////////////////////////
+// Module global data types                         //
+//////////////////////////////////////////////////////
+
+// Output buffering mode
+enum class buf_mode_t
+{
+    BUF_NONE = 0,   // Unbuffered output
+    BUF_LINE,       // Line buffered output
+    BUF_FULL,       // Fully buffered output
+};
+
+// Conversion options
+struct conv_opts
+{
+    scalar_t    from_type   = SCALAR_DFLT;
+    scalar_t    to_type     = scalar_t::TYPE_INVAL;
+    base_t      from_base   = BASE_DFLT;
+    base_t      to_base     = BASE_DFLT;
+    bool        batch       = false;
+    bool        use_mmap    = false;
+    bool        stats       = false;
+    int         threads     = 1;
+    buf_mode_t  buf_mode    = buf_mode_t::BUF_FULL;
+    size_t      buf_size    = OUT_BUF_DFLT;
+    const char *output      = nullptr;
+    group       grp;
+    bool        summary     = false;
+    bool        sort        = false;
+    bool        unique      = false;
+    const char *histogram   = nullptr;
+    bool        raw         = false;
+    endian_t    endian      = ENDIAN_DFLT;
+    int         per_line    = DUMP_PER_LINE_DFLT;
+    bool        addr        = false;
+    bool        col_in      = false;
+    bool        col_out     = false;
+};
+
+// Conversion results of one part of input
+struct conv_part
+{
+    vector<char>    out;            // Converted text buffer
+    size_t          len     = 0;    // Converted text length
+    size_t          n_vals  = 0;    // Number of converted values
+    size_t          n_errs  = 0;    // Number of invalid tokens
+    string          err_tok;        // First invalid token
+    vector<uint64_t> vals;          // Values collected for sorting
+                                    // or columnar output
+};
+
+// Output stream buffer writing onto C stream,
+// used by dump of raw binary input
+class file_buf : public streambuf
+{
+    private:
+        FILE   *file;
+        size_t  count;
+    protected:
+        streamsize
+        xsputn(const char *s, streamsize n) override
+        {
+            size_t done = fwrite(s, 1, (size_t)n, file);
+
+            count += done;
+            return (streamsize)done;
+        }
+        int_type
+        overflow(int_type c) override
+        {
+            if (traits_type::eq_int_type(c, traits_type::eof()))
+                return traits_type::not_eof(c);
+            if (fputc(c, file) == EOF)
+                return traits_type::eof();
+            count++;
+            return c;
+        }
+    public:
+        file_buf(FILE *f) : file(f), count(0) {}
+        // Get number of written bytes
+        size_t
+        written(void)
+        {
+            return count;
+        }
+};
+
+// Conversion statistics
+struct conv_stats
+{
+    size_t  n_vals      = 0;
+    size_t  n_errs      = 0;
+    size_t  bytes_in    = 0;
+    size_t  bytes_out   = 0;
+};
+
+//////////////////////////////////////////////////////
+// Module global objects                            //
+//////////////////////////////////////////////////////
+static conv_opts    opts;
+static conv_stats   stats;
+static int          err_reported;
+static aggregate   *agg;
+static vector<uint64_t> sort_vals;
+static col_writer  *col_file;
+
+//////////////////////////////////////////////////////
+// Module global functions                          //
+//////////////////////////////////////////////////////
+
+// Print usage information
+static void
+usage(void)
+{
+    cerr
+        << "Usage: " TOOL_NAME " [options] [file ...]" << endl
+        << "Convert integer values between enumeration bases "
+           "and scalar types." << endl
+        << "Values are read from files or from STDIN." << endl
+        << endl
+        << "  -f, --from BASE       input base: bin, oct, hex, dec "
+           "(default dec)" << endl
+        << "  -t, --to BASE         output base (default dec)" << endl
+        << "  -F, --from-type TYPE  input type: byte, ubyte, short, ushort,"
+        << endl
+        << "                        long, ulong, double, udouble "
+           "(default long)" << endl
+        << "  -T, --to-type TYPE    output type (default input type)" << endl
+        << "  -o, --output FILE     output file (default STDOUT)" << endl
+        << "  -b, --batch           convert each FILE to FILE" BATCH_EXT
+        << endl
+        << "  -m, --mmap            map input files into memory" << endl
+        << "  -j, --threads N       number of conversion threads" << endl
+        << "  -B, --buffer MODE     output buffering: none, line, "
+           "full[=SIZE]" << endl
+        << "  -g, --group N[:SEP]   split output digits into groups of N"
+        << endl
+        << "                        separated by SEP (default '"
+        << GROUP_SEP_DFLT << "')" << endl
+        << "  -l, --lut             format 8-bit and 16-bit values through"
+        << endl
+        << "                        lookup tables" << endl
+        << "  -a, --aggregate       put summary of input values (count, min,"
+        << endl
+        << "                        max, sum, mean, quantiles) instead of"
+        << endl
+        << "                        converted values" << endl
+        << "  -H, --histogram N:LO:HI" << endl
+        << "                        add histogram of N bins from LO to HI"
+        << endl
+        << "                        to the summary" << endl
+        << "  -S, --sort            put values sorted, one per line" << endl
+        << "  -u, --unique          put sorted values without duplicates"
+        << endl
+        << "  -r, --raw ORDER       input is raw binary data of input type"
+        << endl
+        << "                        in byte order: little, big" << endl
+        << "  -n, --per-line N      number of raw values per line "
+           "(default " << DUMP_PER_LINE_DFLT << ")" << endl
+        << "  -A, --addr            put hexadecimal offset at start of"
+        << endl
+        << "                        each line of raw values" << endl
+        << "  -W, --write-col       put values into indexed columnar file"
+        << endl
+        << "                        of output type" << endl
+        << "  -R, --read-col        input files are columnar files, input"
+        << endl
+        << "                        type is taken from the files" << endl
+        << "  -s, --stats           print throughput summary on STDERR"
+        << endl
+        << "  -h, --help            print this help" << endl;
+}
+
+// Get enumeration base type from its name in short
+// or long form or from its basis value.
+static base_t
+opt_base(const char *val)
+{
+    static const char *names[][3] =
+    {
+        {"bin", BASE_BIN_S, "2"},
+        {"oct", BASE_OCT_S, "8"},
+        {"hex", BASE_HEX_S, "16"},
+        {"dec", BASE_DEC_S, "10"},
+    };
+
+    for (int i = 0; i < (int)base_t::BASE_INVAL; i++)
+    {
+        for (int j = 0; j < 3; j++)
+        {
+            if (strcmp(val, names[i][j]) == 0)
+                return (base_t)i;
+        }
+    }
+
+    return base_t::BASE_INVAL;
+}
+
+// Get scalar value type from its name or
+// from its fixed size integer alias.
+static scalar_t
+opt_type(const char *val)
+{
+    static const char *aliases[] =
+        {"i8", "u8", "i16", "u16", "i32", "u32", "i64", "u64"};
+
+    for (int i = 0; i < (int)scalar_t::TYPE_INTS; i++)
+    {
+        if (strcmp(val, aliases[i]) == 0)
+            return (scalar_t)i;
+    }
+
+    return scalar_str2type(val);
+}
+
+// Get positive count of option value
+//
+// arg[in]  val Option value
+// arg[in]  max Maximal count
+// arg[out] n   Count
+//
+// return 0 on success, -1 on fault
+static int
+opt_count(const char *val, int max, int &n)
+{
+    char               *end;
+    unsigned long long  cnt;
+
+    // Sign is not skipped by strtoull() silently
+    if (*val < '0' || *val > '9')
+        return -1;
+
+    errno = 0;
+    cnt = strtoull(val, &end, 10);
+    if (*end != '\0' || errno != 0 || cnt < 1 || cnt > (unsigned)max)
+        return -1;
+
+    n = (int)cnt;
+
+    return 0;
+}
+
+// Get output buffering mode
+//
+// return 0 on success, -1 on fault
+static int
+opt_buffer(const char *val)
+{
+    if (strcmp(val, "none") == 0)
+        opts.buf_mode = buf_mode_t::BUF_NONE;
+    else if (strcmp(val, "line") == 0)
+        opts.buf_mode = buf_mode_t::BUF_LINE;
+    else if (strncmp(val, "full", 4) == 0)
+    {
+        opts.buf_mode = buf_mode_t::BUF_FULL;
+        if (val[4] == '=')
+        {
+            char       *end;
+            long long   size = strtoll(val + 5, &end, 10);
+
+            if (*end == 'K' || *end == 'k')
+                size <<= 10, end++;
+            else if (*end == 'M' || *end == 'm')
+                size <<= 20, end++;
+
+            if (*end != '\0' || size <= 0)
+                return -1;
+            opts.buf_size = (size_t)size;
+        }
+        else if (val[4] != '\0')
+            return -1;
+    }
+    else
+        return -1;
+
+    return 0;
+}
+
+// Get digit grouping
+//
+// return 0 on success, -1 on fault
+static int
+opt_group(const char *val)
+{
+    char   *end;
+    long    digits  = strtol(val, &end, 10);
+    char    sep     = GROUP_SEP_DFLT;
+
+    if (end == val || digits < 0 || digits > SCALAR_STR_MAX / 2)
+        return -1;
+
+    if (*end == ':' && end[1] != '\0' && end[2] == '\0')
+        sep = end[1];
+    else if (*end != '\0')
+        return -1;
+
+    opts.grp = group((int)digits, sep);
+
+    return 0;
+}
+
+// Check whether character is whitespace separator
+static inline bool
+is_space(char c)
+{
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' ||
+           c == '\v' || c == '\f';
+}
+
+// Convert a part of input text.
+//
+// arg[in]  in      Input text
+// arg[in]  len     Input text length
+// arg[out] part    Conversion results
+static void
+convert_part(const char *in, size_t len, conv_part &part)
+{
+    const char *end     = in + len;
+    size_t      pos     = 0;
+    uint64_t    val;
+    int         n;
+
+    part.n_vals = 0;
+    part.n_errs = 0;
+    part.err_tok.clear();
+    part.vals.clear();
+
+    if (part.out.size() < len + SCALAR_STR_MAX)
+        part.out.resize(len + SCALAR_STR_MAX);
+
+    while (in < end)
+    {
+        const char *tok     = in;
+        char       *out;
+
+        while (in < end && is_space(*in))
+            in++;
+
+        // Output buffer grows on demand, it is kept
+        // between windows to avoid reallocations.
+        if (part.out.size() - pos < (size_t)(in - tok) + SCALAR_STR_MAX)
+            part.out.resize((part.out.size() + (in - tok)) * 2);
+
+        // Copy separators
+        out = part.out.data();
+        memcpy(out + pos, tok, in - tok);
+        pos += in - tok;
+
+        if (in == end)
+            break;
+
+        tok = in;
+        while (in < end && !is_space(*in))
+            in++;
+
+        if (buf_get_int(tok, in - tok, opts.from_type, opts.from_base,
+                        val) != 0)
+        {
+            if (part.n_errs++ == 0)
+                part.err_tok.assign(tok, in - tok > 32 ? 32 : in - tok);
+            continue;
+        }
+
+        part.n_vals++;
+
+        // Values are put after sorting or into columnar file
+        if (opts.sort || opts.col_out)
+        {
+            part.vals.push_back(raw_cast(val, opts.to_type));
+            continue;
+        }
+
+        n = buf_put_int(out + pos, raw_cast(val, opts.to_type),
+                        opts.to_type, opts.to_base, opts.grp);
+        if (n > 0)
+            pos += n;
+    }
+
+    part.len = opts.sort || opts.col_out ? 0 : pos;
+}
+
+// Convert input window splitting it between threads
+// at whitespace positions.
+//
+// arg[in] in       Input text
+// arg[in] len      Input text length
+// arg[in] parts    Conversion results of each thread
+// arg[in] out      Output stream
+// arg[in] name     Input name for messages
+//
+// return 0 on success, -1 on fault
+static int
+convert_window(const char *in, size_t len,
+               vector<conv_part> &parts, FILE *out, const char *name)
+{
+    vector<thread>  workers;
+    size_t          n_parts = parts.size();
+    size_t          offs[THREADS_MAX + 1];
+    int             rc      = 0;
+
+    // Values are only summarized in aggregation mode
+    if (agg != nullptr)
+    {
+        agg->feed_parallel(in, len, (int)n_parts);
+        stats.bytes_in += len;
+        return 0;
+    }
+
+    offs[0] = 0;
+    for (size_t i = 1; i < n_parts; i++)
+    {
+        size_t o = len * i / n_parts;
+
+        if (o < offs[i - 1])
+            o = offs[i - 1];
+        while (o < len && !is_space(in[o]))
+            o++;
+        offs[i] = o;
+    }
+    offs[n_parts] = len;
+
+    if (n_parts == 1)
+        convert_part(in, len, parts[0]);
+    else
+    {
+        for (size_t i = 0; i < n_parts; i++)
+        {
+            workers.emplace_back(convert_part, in + offs[i],
+                                 offs[i + 1] - offs[i], ref(parts[i]));
+        }
+        for (auto &w : workers)
+            w.join();
+    }
+
+    for (size_t i = 0; i < n_parts; i++)
+    {
+        conv_part &part = parts[i];
+
+        if (part.len != 0 &&
+            fwrite(part.out.data(), 1, part.len, out) != part.len)
+        {
+            cerr << TOOL_NAME ": Failed to write output." << endl;
+            rc = -1;
+        }
+
+        stats.n_vals += part.n_vals;
+        if (col_file != nullptr && !opts.sort)
+        {
+            if (col_file->put(part.vals.data(), part.vals.size()) != 0)
+                rc = -1;
+        }
+        else
+            sort_vals.insert(sort_vals.end(), part.vals.begin(),
+                             part.vals.end());
+        stats.n_errs += part.n_errs;
+        stats.bytes_out += part.len;
+
+        if (part.n_errs != 0 && err_reported < ERR_REPORT_MAX)
+        {
+            err_reported++;
+            cerr
+                << TOOL_NAME ": " << name << ": invalid value '"
+                << part.err_tok << "'";
+            if (part.n_errs > 1)
+                cerr << " and " << part.n_errs - 1 << " more";
+            cerr << endl;
+        }
+    }
+
+    if (opts.buf_mode == buf_mode_t::BUF_NONE)
+        fflush(out);
+
+    stats.bytes_in += len;
+
+    return rc;
+}
+
+// Get length of input text up to the last whitespace,
+// so that no token is split between windows.
+//
+// return length of text with complete tokens,
+// 0 if there is no whitespace
+static size_t
+window_cut(const char *in, size_t len)
+{
+    size_t cut = len;
+
+    while (cut > 0 && !is_space(in[cut - 1]))
+        cut--;
+
+    return cut;
+}
+
+// Convert input file read through file descriptor.
+//
+// arg[in] fd       Input file descriptor
+// arg[in] out      Output stream
+// arg[in] name     Input name for messages
+//
+// return 0 on success, -1 on fault
+static int
+convert_fd(int fd, FILE *out, const char *name)
+{
+    size_t              win     = (size_t)BLOCK_SIZE * opts.threads;
+    vector<char>        buf(win);
+    vector<conv_part>   parts(opts.threads);
+    size_t              fill    = 0;
+    int                 rc      = 0;
+
+    for (;;)
+    {
+        long n = (long)read(fd, buf.data() + fill, (unsigned)(win - fill));
+        size_t cut;
+
+        if (n < 0)
+        {
+            cerr << TOOL_NAME ": " << name << ": Failed to read input."
+                 << endl;
+            return -1;
+        }
+        if (n == 0)
+            break;
+
+        fill += n;
+
+        // Interactive input is converted as soon as it arrives,
+        // bulk input is converted by complete windows.
+        if (fill < win && opts.buf_mode == buf_mode_t::BUF_FULL)
+            continue;
+
+        cut = window_cut(buf.data(), fill);
+        if (cut == 0)
+        {
+            if (fill < win)
+                continue;
+            cut = fill;
+        }
+
+        if (convert_window(buf.data(), cut, parts, out, name) != 0)
+            rc = -1;
+
+        memmove(buf.data(), buf.data() + cut, fill - cut);
+        fill -= cut;
+    }
+
+    if (fill != 0 && convert_window(buf.data(), fill, parts, out, name) != 0)
+        rc = -1;
+
+    return rc;
+}
+
+// Convert input file mapped into memory.
+//
+// arg[in] fd       Input file descriptor
+// arg[in] out      Output stream
+// arg[in] name     Input name for messages
+//
+// return 0 on success, -1 on fault,
+// 1 if file can not be mapped
+static int
+convert_mmap(int fd, FILE *out, const char *name)
+{
+#ifdef _WIN32
+    (void)fd;
+    (void)out;
+    (void)name;
+    return 1;
+#else
+    struct stat         st;
+    size_t              win     = (size_t)BLOCK_SIZE * opts.threads;
+    vector<conv_part>   parts(opts.threads);
+    const char         *data;
+    size_t              size;
+    size_t              pos     = 0;
+    int                 rc      = 0;
+
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+        return 1;
+
+    size = (size_t)st.st_size;
+    if (size == 0)
+        return 0;
+
+    data = (const char *)mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED)
+        return 1;
+    madvise((void *)data, size, MADV_SEQUENTIAL);
+
+    while (pos < size)
+    {
+        size_t len = size - pos > win ? win : size - pos;
+
+        if (pos + len < size && window_cut(data + pos, len) != 0)
+            len = window_cut(data + pos, len);
+
+        if (convert_window(data + pos, len, parts, out, name) != 0)
+            rc = -1;
+        pos += len;
+    }
+
+    munmap((void *)data, size);
+
+    return rc;
+#endif
+}
+
+// Put typed dump of raw binary input file
+//
+// arg[in] fd       Input file descriptor
+// arg[in] out      Output stream
+// arg[in] name     Input name for messages
+//
+// return 0 on success, -1 on fault
+static int
+dump_fd(int fd, FILE *out, const char *name)
+{
+    file_buf    buf(out);
+    ostream     os(&buf);
+    dump        d(opts.from_type, opts.to_base, opts.endian, opts.per_line);
+    int         rc;
+
+    d.set_addr(opts.addr);
+    d.set_group(opts.grp);
+    rc = d.put_fd(os, fd);
+    os.flush();
+    stats.bytes_out += buf.written();
+
+    if (rc != 0)
+        cerr << TOOL_NAME ": " << name << ": Failed to dump file." << endl;
+
+    return rc;
+}
+
+// Start columnar output onto output stream
+//
+// arg[in] out      Output stream
+//
+// return 0 on success, -1 on fault
+static int
+col_open(FILE *out)
+{
+    if (!opts.col_out || col_file != nullptr)
+        return 0;
+
+    col_file = new col_writer(opts.to_type);
+    if (col_file->open(out) != 0)
+    {
+        delete col_file;
+        col_file = nullptr;
+        return -1;
+    }
+
+    return 0;
+}
+
+// Convert columnar input file. Values are put in string
+// form by the reader, or decoded by blocks into columnar
+// output or collected for sorting.
+//
+// arg[in] path     Input file path
+// arg[in] out      Output stream
+//
+// return 0 on success, -1 on fault
+static int
+convert_col(const char *path, FILE *out)
+{
+    col_reader          col;
+    vector<uint64_t>    vals;
+    int                 rc      = 0;
+
+    if (col.open(path) != 0)
+    {
+        cerr << TOOL_NAME ": " << path << ": Failed to read columnar file."
+             << endl;
+        return -1;
+    }
+
+    if (opts.to_type == scalar_t::TYPE_INVAL)
+        opts.to_type = col.type();
+    if (col_open(out) != 0)
+        return -1;
+
+    stats.n_vals += col.count();
+    for (size_t blk = 0; blk < col.blocks(); blk++)
+        stats.bytes_in += col.block(blk).size;
+
+    // Text output is put by the reader
+    if (col_file == nullptr && !opts.sort)
+    {
+        file_buf    buf(out);
+        ostream     os(&buf);
+
+        rc = col.put_text(os, opts.to_type, opts.to_base, opts.grp);
+        os.flush();
+        stats.bytes_out += buf.written();
+    }
+    else
+        vals.resize(COL_BLOCK_VALS);
+
+    for (size_t blk = 0; blk < col.blocks() && !vals.empty() && rc == 0;
+         blk++)
+    {
+        size_t count = col.block(blk).count;
+
+        rc = col.decode(blk, vals.data());
+        for (size_t i = 0; i < count && rc == 0; i++)
+            vals[i] = raw_cast(vals[i], opts.to_type);
+
+        if (rc != 0)
+            break;
+        else if (opts.sort)
+            sort_vals.insert(sort_vals.end(), vals.begin(),
+                             vals.begin() + count);
+        else
+            rc = col_file->put(vals.data(), count);
+    }
+
+    if (rc != 0)
+        cerr << TOOL_NAME ": " << path << ": Failed to convert file."
+             << endl;
+
+    return rc;
+}
+
+// Convert input file
+//
+// arg[in] path     Input file path, nullptr for STDIN
+// arg[in] out      Output stream
+//
+// return 0 on success, -1 on fault
+static int
+convert_file(const char *path, FILE *out)
+{
+    const char *name    = path != nullptr ? path : "STDIN";
+    int         fd      = 0;
+    int         rc      = 1;
+
+    if (opts.col_in)
+    {
+        if (path != nullptr)
+            return convert_col(path, out);
+
+        cerr << TOOL_NAME ": Columnar input must be read from file."
+             << endl;
+        return -1;
+    }
+
+    if (path != nullptr)
+    {
+        fd = open(path, O_RDONLY);
+        if (fd < 0)
+        {
+            cerr << TOOL_NAME ": " << path << ": Failed to open file."
+                 << endl;
+            return -1;
+        }
+    }
+
+    if (opts.raw)
+        rc = dump_fd(fd, out, name);
+    else if (opts.use_mmap)
+        rc = convert_mmap(fd, out, name);
+    if (rc > 0)
+        rc = convert_fd(fd, out, name);
+
+    if (path != nullptr)
+        close(fd);
+
+    return rc;
+}
+
+// Set up aggregation of input values
+//
+// return 0 on success, -1 on fault
+static int
+agg_open(void)
+{
+    const char *p       = opts.histogram;
+    uint64_t    bound[2];
+    char       *end;
+    long        bins;
+
+    agg = new aggregate(opts.from_type, opts.from_base);
+    if (p == nullptr)
+        return 0;
+
+    bins = strtol(p, &end, 10);
+    if (end == p || *end != ':' || bins <= 0)
+        return -1;
+
+    for (int i = 0; i < 2; i++)
+    {
+        p = end + 1;
+        end = (char *)strchr(p, i == 0 ? ':' : '\0');
+        if (end == nullptr ||
+            buf_get_int(p, end - p, opts.from_type, opts.from_base,
+                        bound[i]) != 0)
+            return -1;
+    }
+
+    return agg->set_histogram((int)bins, bound[0], bound[1]);
+}
+
+// Put summary of aggregated values onto output stream
+//
+// arg[in] out      Output stream
+static void
+agg_report(FILE *out)
+{
+    ostringstream   report;
+    string          text;
+
+    agg->finish();
+    agg->report(report, opts.to_base);
+    text = report.str();
+    fwrite(text.data(), 1, text.size(), out);
+
+    stats.n_vals += agg->count();
+    stats.n_errs += agg->errors();
+    agg->reset();
+}
+
+// Sort collected values and put them onto output stream,
+// one value per line, or into columnar output.
+//
+// arg[in] out      Output stream
+//
+// return 0 on success, -1 on fault
+static int
+sort_flush(FILE *out)
+{
+    const size_t    chunk   = 1 << 16;
+    vector<char>    buf(chunk + SCALAR_STR_MAX + 1);
+    long long       n;
+    size_t          pos     = 0;
+    int             rc      = 0;
+
+    n = radix_sort(sort_vals.data(), sort_vals.size(), opts.to_type,
+                   opts.unique, opts.threads);
+
+    if (col_file != nullptr)
+    {
+        rc = col_file->put(sort_vals.data(), n > 0 ? (size_t)n : 0);
+        sort_vals.clear();
+        return rc;
+    }
+
+    for (long long i = 0; i < n; i++)
+    {
+        pos += buf_put_int(buf.data() + pos, sort_vals[i],
+                           opts.to_type, opts.to_base, opts.grp);
+        buf[pos++] = '\n';
+
+        if (pos >= chunk || i == n - 1)
+        {
+            if (fwrite(buf.data(), 1, pos, out) != pos)
+                rc = -1;
+            stats.bytes_out += pos;
+            pos = 0;
+        }
+    }
+
+    sort_vals.clear();
+
+    return rc;
+}
+
+// Set output buffering mode of output stream
+//
+// arg[in] out      Output stream
+static void
+set_buffering(FILE *out)
+{
+    switch (opts.buf_mode)
+    {
+        case buf_mode_t::BUF_NONE:
+            setvbuf(out, nullptr, _IONBF, 0);
+            break;
+        case buf_mode_t::BUF_LINE:
+            setvbuf(out, nullptr, _IOLBF, BUFSIZ);
+            break;
+        case buf_mode_t::BUF_FULL:
+            setvbuf(out, nullptr, _IOFBF, opts.buf_size);
+            break;
+    }
+}
+
+// Open output stream
+//
+// arg[in] path     Output file path, nullptr for STDOUT
+//
+// return output stream on success, nullptr on fault
+static FILE*
+out_open(const char *path)
+{
+    FILE *out = stdout;
+
+    if (path != nullptr)
+    {
+        out = fopen(path, "wb");
+        if (out == nullptr)
+        {
+            cerr << TOOL_NAME ": " << path << ": Failed to create file."
+                 << endl;
+            return nullptr;
+        }
+    }
+
+    set_buffering(out);
+
+    if (opts.to_type != scalar_t::TYPE_INVAL && col_open(out) != 0)
+    {
+        if (out != stdout)
+            fclose(out);
+        return nullptr;
+    }
+
+    return out;
+}
+
+// Close output stream, columnar output gets its index
+//
+// return 0 on success, -1 on fault
+static int
+out_close(FILE *out)
+{
+    int rc = 0;
+
+    if (col_file != nullptr)
+    {
+        rc = col_file->close();
+        delete col_file;
+        col_file = nullptr;
+    }
+
+    rc |= fflush(out);
+
+    if (out != stdout)
+        rc |= fclose(out);
+
+    if (rc != 0)
+    {
+        cerr << TOOL_NAME ": Failed to write output." << endl;
+        return -1;
+    }
+
+    return 0;
+}
+
+// Print throughput summary
+//
+// arg[in] sec      Elapsed time in seconds
+static void
+print_stats(double sec)
+{
+    double mb_in    = (double)stats.bytes_in / (1 << 20);
+    double mb_out   = (double)stats.bytes_out / (1 << 20);
+
+    if (sec <= 0)
+        sec = 1e-9;
+
+    fprintf(stderr,
+            TOOL_NAME ": %zu values, %zu errors, %d thread(s), %s kernels\n"
+            TOOL_NAME ": in %.2f MiB, out %.2f MiB, %.3f s\n"
+            TOOL_NAME ": %.2f MiB/s in, %.2f MiB/s out, %.2f M values/s\n",
+            stats.n_vals, stats.n_errs, opts.threads, isa_name(cpu_isa()),
+            mb_in, mb_out, sec,
+            mb_in / sec, mb_out / sec, stats.n_vals / sec / 1e6);
+}
+
+//////////////////////////////////////////////////////
+// Tool entry point                                 //
+//////////////////////////////////////////////////////
+int
+main(int argc, char **argv)
+{
+    vector<const char *>    files;
+    int                     rc      = 0;
+    chrono::steady_clock::time_point start;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        const char *val = i + 1 < argc ? argv[i + 1] : nullptr;
+        bool        bad = false;
+
+#define OPT(_short, _long) \
+        (strcmp(arg, _short) == 0 || strcmp(arg, _long) == 0)
+#define OPT_VAL                                                         \
+        if (val == nullptr)                                             \
+        {                                                               \
+            cerr << TOOL_NAME ": Option '" << arg                       \
+                 << "' requires a value." << endl;                      \
+            return 2;                                                   \
+        }                                                               \
+        i++;
+
+        if (OPT("-h", "--help"))
+        {
+            usage();
+            return 0;
+        }
+        else if (OPT("-f", "--from"))
+        {
+            OPT_VAL
+            opts.from_base = opt_base(val);
+            bad = opts.from_base == base_t::BASE_INVAL;
+        }
+        else if (OPT("-t", "--to"))
+        {
+            OPT_VAL
+            opts.to_base = opt_base(val);
+            bad = opts.to_base == base_t::BASE_INVAL;
+        }
+        else if (OPT("-F", "--from-type"))
+        {
+            OPT_VAL
+            opts.from_type = opt_type(val);
+            bad = opts.from_type == scalar_t::TYPE_INVAL;
+        }
+        else if (OPT("-T", "--to-type"))
+        {
+            OPT_VAL
+            opts.to_type = opt_type(val);
+            bad = opts.to_type == scalar_t::TYPE_INVAL;
+        }
+        else if (OPT("-o", "--output"))
+        {
+            OPT_VAL
+            opts.output = val;
+        }
+        else if (OPT("-b", "--batch"))
+            opts.batch = true;
+        else if (OPT("-m", "--mmap"))
+            opts.use_mmap = true;
+        else if (OPT("-l", "--lut"))
+            buf_lut_enable(true);
+        else if (OPT("-a", "--aggregate"))
+            opts.summary = true;
+        else if (OPT("-H", "--histogram"))
+        {
+            OPT_VAL
+            opts.histogram = val;
+            opts.summary = true;
+        }
+        else if (OPT("-S", "--sort"))
+            opts.sort = true;
+        else if (OPT("-u", "--unique"))
+            opts.sort = opts.unique = true;
+        else if (OPT("-r", "--raw"))
+        {
+            OPT_VAL
+            opts.raw = true;
+            opts.endian = endian_str2type(val);
+            bad = opts.endian == endian_t::ENDIAN_INVAL;
+        }
+        else if (OPT("-n", "--per-line"))
+        {
+            OPT_VAL
+            bad = opt_count(val, PER_LINE_MAX, opts.per_line) != 0;
+        }
+        else if (OPT("-A", "--addr"))
+            opts.addr = true;
+        else if (OPT("-W", "--write-col"))
+            opts.col_out = true;
+        else if (OPT("-R", "--read-col"))
+            opts.col_in = true;
+        else if (OPT("-s", "--stats"))
+            opts.stats = true;
+        else if (OPT("-j", "--threads"))
+        {
+            OPT_VAL
+            bad = opt_count(val, THREADS_MAX, opts.threads) != 0;
+        }
+        else if (OPT("-g", "--group"))
+        {
+            OPT_VAL
+            bad = opt_group(val) != 0;
+        }
+        else if (OPT("-B", "--buffer"))
+        {
+            OPT_VAL
+            bad = opt_buffer(val) != 0;
+        }
+        else if (arg[0] == '-' && arg[1] != '\0')
+        {
+            cerr << TOOL_NAME ": Unknown option '" << arg << "'." << endl;
+            usage();
+            return 2;
+        }
+        else
+            files.push_back(arg);
+#undef OPT_VAL
+#undef OPT
+
+        if (bad)
+        {
+            cerr << TOOL_NAME ": Invalid value '" << val
+                 << "' of option '" << arg << "'." << endl;
+            return 2;
+        }
+    }
+
+    // Columnar input keeps type of the first file unless
+    // it is converted, see convert_col()
+    if (opts.to_type == scalar_t::TYPE_INVAL && !opts.col_in)
+        opts.to_type = opts.from_type;
+
+    // Interactive modes convert data as soon as it arrives
+    if (opts.buf_mode != buf_mode_t::BUF_FULL)
+        opts.threads = 1;
+
+    if (opts.batch && (files.empty() || opts.output != nullptr))
+    {
+        cerr << TOOL_NAME ": Batch mode requires input files "
+                "and no output file." << endl;
+        return 2;
+    }
+
+    if (opts.raw && (opts.summary || opts.sort))
+    {
+        cerr << TOOL_NAME ": Raw input can not be aggregated "
+                "or sorted." << endl;
+        return 2;
+    }
+
+    if ((opts.col_in || opts.col_out) && (opts.raw || opts.summary))
+    {
+        cerr << TOOL_NAME ": Columnar files can not be used with raw "
+                "input or aggregated." << endl;
+        return 2;
+    }
+
+    if (opts.summary && agg_open() != 0)
+    {
+        cerr << TOOL_NAME ": Invalid histogram '" << opts.histogram
+             << "'." << endl;
+        return 2;
+    }
+
+    start = chrono::steady_clock::now();
+
+    if (opts.batch)
+    {
+        for (const char *path : files)
+        {
+            string  out_path = string(path) + BATCH_EXT;
+            FILE   *out = out_open(out_path.c_str());
+
+            if (out == nullptr)
+            {
+                rc = 1;
+                continue;
+            }
+            if (convert_file(path, out) != 0)
+                rc = 1;
+            if (agg != nullptr)
+                agg_report(out);
+            else if (opts.sort && sort_flush(out) != 0)
+                rc = 1;
+            if (out_close(out) != 0)
+                rc = 1;
+        }
+    }
+    else
+    {
+        FILE *out = out_open(opts.output);
+
+        if (out == nullptr)
+            return 1;
+
+        if (files.empty())
+            files.push_back(nullptr);
+
+        for (const char *path : files)
+        {
+            if (convert_file(path, out) != 0)
+                rc = 1;
+        }
+        if (agg != nullptr)
+            agg_report(out);
+        else if (opts.sort && sort_flush(out) != 0)
+            rc = 1;
+        if (out_close(out) != 0)
+            rc = 1;
+    }
+
+    if (opts.stats)
+    {
+        print_stats(chrono::duration<double>(
+            chrono::steady_clock::now() - start).count());
+    }
+
+    if (stats.n_errs != 0)
+        rc = 1;
+
+    return rc;
+}
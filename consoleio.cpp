@@ -1,8 +1,11 @@
 #include "consoleio.h"
+#include "consoleio_cpu.h"
+#include "consoleio_shm.h"
 #include <string>
-#include <iomanip>
-#include <bitset>
 #include <cstring>
+#include <cstdio>
+#include <mutex>
+#include <atomic>
 
 //////////////////////////////////////////////////////
 // Module global namespace                          //
@@ -27,6 +30,13 @@ using namespace std;
 #define PREFIX_STR_HEX "0x"     // Hexadecimal
 // No printable prefix for decimal representation
 
+// Byte order reverse of 64-bit value
+#ifdef _MSC_VER
+#define BSWAP64(_val) _byteswap_uint64(_val)
+#else
+#define BSWAP64(_val) __builtin_bswap64(_val)
+#endif
+
 //////////////////////////////////////////////////////
 // Module global data types                         //
 //////////////////////////////////////////////////////
@@ -99,6 +109,42 @@ static const int
 base_w_double[] =
     {BASE_BIN_W_DOUBLE, BASE_OCT_W_DOUBLE, BASE_HEX_W_DOUBLE, BASE_DEC_W_DOUBLE};
 
+// Printable width of integer values in various base types
+// indexed by scalar type index divided by 2 ('char', 'short',
+// 'long' and 'long long' values)
+static const int*
+base_w_type[] =
+    {base_w_char, base_w_short, base_w_long, base_w_double};
+
+// Scalar value type name
+static const char*
+scalar_name[] =
+    {TYPE_BYTE_S, TYPE_UBYTE_S, TYPE_SHORT_S, TYPE_USHORT_S,
+     TYPE_LONG_S, TYPE_ULONG_S, TYPE_DOUBLE_S, TYPE_UDOUBLE_S};
+
+// Size of scalar values in bits
+static const int
+scalar_bits_n[] = {8, 8, 16, 16, 32, 32, 64, 64};
+
+// Digit characters for string representation
+// of integer values, lower case as 'hex' I/O manip puts
+static const char
+digit_chr[] = "0123456789abcdef";
+
+// Pairs of decimal digits from "00" to "99"
+static const char
+digit_pair_dec[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
 //////////////////////////////////////////////////////
 // Module global functions                          //
 //////////////////////////////////////////////////////
@@ -134,6 +180,27 @@ base_str2type(const char *val)
     return rc;
 }
 
+// Get bit mask of integer value of given size
+static inline uint64_t
+bits_mask(int bits)
+{
+    return bits >= 64 ? ~(uint64_t)0 : (((uint64_t)1 << bits) - 1);
+}
+
+// Get digit value of character in any enumeration base
+//
+// return digit value, 0xff for non-digit characters
+static inline unsigned
+digit_val(unsigned char c)
+{
+    if ((unsigned)(c - '0') < 10)
+        return c - '0';
+    c |= 0x20;
+    if ((unsigned)(c - 'a') < 6)
+        return c - 'a' + 10;
+    return 0xff;
+}
+
 // Convert value from the string form to integer.
 // Octal, decimal and hexadecimal representations are supported.
 // Signed and unsigned types are supported.
@@ -241,198 +308,668 @@ console_get_scalar(scalar &val)
 
 // Namespace for binary output functions
 namespace bin_out {
-// Put integer value onto generic output in binary format.
+// Spread 8 bits of integer value into 8 bytes holding
+// binary digits, most significant digit goes first
+// in memory (little-endian hosts). Vector variants
+// are selected at runtime (see consoleio_cpu.h).
+static inline uint64_t
+spread8(uint64_t val)
+{
+    // Replicate byte, isolate one bit in each byte
+    // and turn nonzero bytes into 1.
+    val = (val & 0xff) * 0x0101010101010101ULL;
+    val &= 0x0102040810204080ULL;
+    val = ((val + 0x7f7f7f7f7f7f7f7fULL) >> 7) & 0x0101010101010101ULL;
+
+    return val | 0x3030303030303030ULL;
+}
+
+// Put integer value into character buffer in binary format.
 //
-// arg[in] stream   Output stream, STDOUT or STDERR
-// arg[in] val      Scalar value type
+// arg[out] buf     Character buffer
+// arg[in]  val     Integer value masked to its size
+// arg[in]  bits    Size of integer value in bits
 //
-// return Status, 0 - success, -1 - fault
+// return number of characters put
 static int
-stream_put_int_gen(ostream &stream, scalar &val)
+buf_put_int(char *buf, uint64_t val, int bits)
 {
-    void*       val_ptr     = val.val_ptr();
-    scalar_t    val_type    = val.val_type();
-    base_t      val_base    = val.val_base();
-    int         p_width;
-
-    if (val_base != base_t::BASE_BIN)
+    for (int i = bits - 8; i >= 0; i -= 8)
     {
-        cerr
-            << __FUNCTION__ << "() "
-            << "enumeration base is not supported." << endl;
-        return -1;
-    }
+        uint64_t digits = spread8(val >> i);
 
-    switch (val_type)
-    {
-        case scalar_t::TYPE_BYTE:
-        case scalar_t::TYPE_UBYTE:
-            p_width = val.enum_base.w_char();
-            stream << setfill(FILL) << setw(p_width) << bitset<8>(*((uint8_t *)val_ptr));
-            return 0;
-        case scalar_t::TYPE_SHORT:
-        case scalar_t::TYPE_USHORT:
-            p_width = val.enum_base.w_short();
-            stream << setfill(FILL) << setw(p_width) << bitset<16>(*((uint16_t *)val_ptr));
-            return 0;
-        case scalar_t::TYPE_LONG:
-        case scalar_t::TYPE_ULONG:
-            p_width = val.enum_base.w_long();
-            stream << setfill(FILL) << setw(p_width) << bitset<32>(*((uint32_t *)val_ptr));
-            return 0;
-        case scalar_t::TYPE_DOUBLE:
-        case scalar_t::TYPE_UDOUBLE:
-            p_width = val.enum_base.w_double();
-            stream << setfill(FILL) << setw(p_width) << bitset<64>(*((uint64_t *)val_ptr));
-            return 0;
-        default:
-            cerr << __FUNCTION__ << "() Value type is invalid." << endl;
+        memcpy(buf, &digits, 8);
+        buf += 8;
     }
 
-    return -1;
+    return bits;
 }
-} // namespace bin_out
 
-// Function body macro
+// Put integer value into character buffer in binary format
+// split into nibble or byte groups. Groups are put straight
+// with separator bytes deposited between them, so grouping
+// costs no more stores than plain output.
 //
-// arg _manip   I/O manip 'hex' or 'oct'
-// arg _base_t  Base type 'HEX' or 'OCT'
-#define STREAM_PUT_INT_GEN(_manip, _base_t) \
-{                                                                       \
-    scalar_t    val_type    = val.val_type();                           \
-    base_t      val_base    = val.val_base();                           \
-    int         p_width;                                                \
-                                                                        \
-    if (val_base != base_t::BASE_##_base_t)                             \
-    {                                                                   \
-        cerr                                                            \
-         << __FUNCTION__ << "() Enumeration base is invalid." << endl;  \
-        return -1;                                                      \
-    }                                                                   \
-                                                                        \
-    switch (val_type)                                                   \
-    {                                                                   \
-        case scalar_t::TYPE_BYTE:                                       \
-        case scalar_t::TYPE_UBYTE:                                      \
-            p_width = val.enum_base.w_char();                           \
-            break;                                                      \
-        case scalar_t::TYPE_SHORT:                                      \
-        case scalar_t::TYPE_USHORT:                                     \
-            p_width = val.enum_base.w_short();                          \
-            break;                                                      \
-        case scalar_t::TYPE_LONG:                                       \
-        case scalar_t::TYPE_ULONG:                                      \
-            p_width = val.enum_base.w_long();                           \
-            break;                                                      \
-        case scalar_t::TYPE_DOUBLE:                                     \
-        case scalar_t::TYPE_UDOUBLE:                                    \
-            p_width = val.enum_base.w_double();                         \
-            break;                                                      \
-        default:                                                        \
-            cerr                                                        \
-                << __FUNCTION__ << "() Value type is invalid." << endl; \
-            return -1;                                                  \
-    }                                                                   \
-                                                                        \
-    if (val_type == scalar_t::TYPE_DOUBLE ||                            \
-        val_type == scalar_t::TYPE_UDOUBLE)                             \
-    {                                                                   \
-        stream                                                          \
-            << _manip << setfill(FILL) << setw(p_width)                 \
-            << val.val_ud();                                            \
-    }                                                                   \
-    else                                                                \
-    {                                                                   \
-        stream                                                          \
-            << _manip << setfill(FILL) << setw(p_width)                 \
-            << val.val_ul();                                            \
-    }                                                                   \
-                                                                        \
-    return 0;                                                           \
+// arg[out] buf     Character buffer
+// arg[in]  val     Integer value masked to its size
+// arg[in]  bits    Size of integer value in bits
+// arg[in]  grp     Digit grouping, 4 or 8 digits
+//
+// return number of characters put
+static int
+buf_put_grouped(char *buf, uint64_t val, int bits, group grp)
+{
+    uint64_t    sep     = (uint8_t)grp.sep();
+    char       *p       = buf;
+
+    for (int i = bits - 8; i >= 0; i -= 8)
+    {
+        uint64_t digits = spread8(val >> i);
+
+        if (grp.digits() == 4)
+        {
+            uint64_t hi = (uint32_t)digits | sep << 32;
+            uint64_t lo = (digits >> 32) | sep << 32;
+
+            memcpy(p, &hi, 8);
+            memcpy(p + 5, &lo, 8);
+            p += 10;
+        }
+        else
+        {
+            memcpy(p, &digits, 8);
+            p[8] = (char)sep;
+            p += 9;
+        }
+    }
+
+    // No separator after the last group
+    return (int)(p - buf) - 1;
 }
+} // namespace bin_out
 
 // Namespace for printout in octal format
 namespace oct_out {
-// Put integer value onto generic output in octal format.
+// Put integer value into character buffer in octal format.
 //
-// arg[in] stream   Output stream, STDOUT or STDERR
-// arg[in] val      Scalar value type
+// arg[out] buf     Character buffer
+// arg[in]  val     Integer value masked to its size
+// arg[in]  width   Printable width in characters
 //
-// return Status, 0 - success, -1 - fault
+// return number of characters put
 static int
-stream_put_int_gen(ostream &stream, scalar &val)
-STREAM_PUT_INT_GEN(oct, OCT)
+buf_put_int(char *buf, uint64_t val, int width)
+{
+    for (int i = width - 1; i >= 0; i--)
+    {
+        buf[i] = digit_chr[val & 7];
+        val >>= 3;
+    }
+
+    return width;
+}
 } // namespace oct_out
 
 // Namespace for printout in hexadecimal format.
 namespace hex_out {
-// Put integer value onto generic output in hexadecimal format.
+// Spread 32 bits of integer value into 8 bytes holding
+// hexadecimal digits, most significant digit goes first
+// in memory (little-endian hosts).
+static inline uint64_t
+spread32(uint32_t val)
+{
+    uint64_t x = val;
+
+    x = (x | x << 16) & 0x0000ffff0000ffffULL;
+    x = (x | x << 8)  & 0x00ff00ff00ff00ffULL;
+    x = (x | x << 4)  & 0x0f0f0f0f0f0f0f0fULL;
+    x = BSWAP64(x);
+
+    // Nibbles 10..15 get extra offset from '9' to 'a'
+    return x + 0x3030303030303030ULL +
+           (((x + 0x0606060606060606ULL) >> 4) & 0x0101010101010101ULL) *
+           ('a' - '9' - 1);
+}
+
+// Put integer value into character buffer in hexadecimal format.
 //
-// arg[in] stream   Output stream, STDOUT or STDERR
-// arg[in] val      Scalar value
+// arg[out] buf     Character buffer
+// arg[in]  val     Integer value masked to its size
+// arg[in]  width   Printable width in characters
 //
-// return 0 - success, -1 - fault
+// return number of characters put
 static int
-stream_put_int_gen(ostream &stream, scalar &val)
-STREAM_PUT_INT_GEN(hex, HEX)
+buf_put_int(char *buf, uint64_t val, int width)
+{
+    uint64_t    digits;
+    int         len     = width;
+
+    if (width > 8)
+    {
+        digits = spread32((uint32_t)(val >> 32));
+        memcpy(buf, &digits, 8);
+        buf += 8;
+        width -= 8;
+    }
+
+    // Shorter values are aligned to the left
+    digits = spread32((uint32_t)val << (32 - width * 4));
+    memcpy(buf, &digits, 8);
+
+    return len;
+}
 } // Namespace hex_out
 
+// Namespace for printout in decimal format.
+namespace dec_out {
+// Put integer value into character buffer in decimal format.
+// Decimal values are put without fulfill symbols and sign.
+//
+// arg[out] buf     Character buffer
+// arg[in]  val     Absolute integer value
+//
+// return number of characters put
+static int
+buf_put_int(char *buf, uint64_t val)
+{
+    char    digits[BASE_DEC_W_DOUBLE];
+    char   *end     = digits + sizeof(digits);
+    char   *p       = end;
+
+    while (val >= 100)
+    {
+        unsigned pair = (unsigned)(val % 100) * 2;
+
+        val /= 100;
+        p -= 2;
+        p[0] = digit_pair_dec[pair];
+        p[1] = digit_pair_dec[pair + 1];
+    }
+    if (val >= 10)
+    {
+        p -= 2;
+        p[0] = digit_pair_dec[val * 2];
+        p[1] = digit_pair_dec[val * 2 + 1];
+    }
+    else
+        *--p = (char)('0' + val);
+
+    memcpy(buf, p, end - p);
+
+    return (int)(end - p);
+}
+} // Namespace dec_out
+
+// Namespace for precomputed lookup tables of string
+// representation of 8-bit and 16-bit values.
+namespace lut_io {
+// Each table entry is 8 bytes slot holding text aligned to
+// the left and zero-filled to printable width, so a value
+// is put with a single fixed size copy. Decimal entries
+// are not fulfilled, their length is kept in the last byte.
+#define LUT_SLOT_LEN 7
+
+// Text of 8-bit values in all enumeration bases
+static uint64_t        *lut8[(int)base_t::BASE_INVAL];
+// Text of 16-bit values in hexadecimal and decimal bases
+static uint32_t        *lut16_hex;
+static uint64_t        *lut16_dec;
+// Values of pairs of hexadecimal digits indexed by
+// two characters, -1 for non-digit pairs
+static int16_t         *lut_hex2;
+
+static once_flag        lut_once;
+static atomic<bool>     lut_on;
+
+// Build lookup tables
+static void
+build(void)
+{
+    char slot[SCALAR_STR_MAX];
+
+    for (int b = 0; b < (int)base_t::BASE_INVAL; b++)
+        lut8[b] = new uint64_t[1 << 8];
+    lut16_hex = new uint32_t[1 << 16];
+    lut16_dec = new uint64_t[1 << 16];
+    lut_hex2 = new int16_t[1 << 16];
+
+    for (uint64_t v = 0; v < (1 << 8); v++)
+    {
+        bin_out::buf_put_int(slot, v, 8);
+        memcpy(&lut8[(int)base_t::BASE_BIN][v], slot, 8);
+        oct_out::buf_put_int(slot, v, BASE_OCT_W_CHAR);
+        memcpy(&lut8[(int)base_t::BASE_OCT][v], slot, 8);
+        hex_out::buf_put_int(slot, v, BASE_HEX_W_CHAR);
+        memcpy(&lut8[(int)base_t::BASE_HEX][v], slot, 8);
+        slot[LUT_SLOT_LEN] = (char)dec_out::buf_put_int(slot, v);
+        memcpy(&lut8[(int)base_t::BASE_DEC][v], slot, 8);
+    }
+
+    for (uint64_t v = 0; v < (1 << 16); v++)
+    {
+        char c[2];
+
+        hex_out::buf_put_int(slot, v, BASE_HEX_W_SHORT);
+        memcpy(&lut16_hex[v], slot, 4);
+        slot[LUT_SLOT_LEN] = (char)dec_out::buf_put_int(slot, v);
+        memcpy(&lut16_dec[v], slot, 8);
+
+        memcpy(c, &v, 2);
+        if (digit_val(c[0]) < 16 && digit_val(c[1]) < 16)
+            lut_hex2[v] = (int16_t)(digit_val(c[0]) << 4 | digit_val(c[1]));
+        else
+            lut_hex2[v] = -1;
+    }
+}
+
+// Put integer value into character buffer through lookup tables.
+//
+// arg[out] buf     Character buffer
+// arg[in]  val     Raw integer value
+// arg[in]  bits    Size of integer value in bits, 8 or 16
+// arg[in]  sign    Whether value is of signed type
+// arg[in]  base    Enumeration base type
+//
+// return number of characters put,
+// 0 if value is not covered by the tables
+static inline int
+buf_put_int(char *buf, uint64_t val, int bits, bool sign, base_t base)
+{
+    uint64_t    slot;
+    int         len     = 0;
+
+    if (base == base_t::BASE_DEC)
+    {
+        if (sign && (int64_t)val < 0)
+        {
+            buf[len++] = '-';
+            val = 0 - val;
+        }
+        slot = bits == 8 ? lut8[(int)base][val & 0xff] : lut16_dec[val & 0xffff];
+        memcpy(buf + len, &slot, 8);
+
+        return len + (int)(slot >> (LUT_SLOT_LEN * 8));
+    }
+
+    if (bits == 8)
+    {
+        memcpy(buf, &lut8[(int)base][val & 0xff], 8);
+        return base_w_char[(int)base];
+    }
+
+    if (base == base_t::BASE_HEX)
+    {
+        memcpy(buf, &lut16_hex[val & 0xffff], 4);
+        return BASE_HEX_W_SHORT;
+    }
+
+    return 0;
+}
+
+// Get value of 2 or 4 hexadecimal digits through lookup table.
+//
+// return value on success, -1 on fault
+static inline long
+buf_get_hex(const char *str, size_t len)
+{
+    uint16_t    pair;
+    long        hi;
+    long        lo;
+
+    memcpy(&pair, str, 2);
+    hi = lut_hex2[pair];
+    if (len == 2 || hi < 0)
+        return hi;
+
+    memcpy(&pair, str + 2, 2);
+    lo = lut_hex2[pair];
+
+    return lo < 0 ? -1 : hi << 8 | lo;
+}
+#undef LUT_SLOT_LEN
+} // Namespace lut_io
+
+// Put digits into character buffer split into groups,
+// the first group may be shorter than others. Groups up to
+// 16 digits are moved with fixed size copies while the
+// buffer has enough room.
+//
+// arg[out] buf     Character buffer
+// arg[in]  digits  Digits, readable up to 16 characters
+//                  beyond the last one
+// arg[in]  n       Number of digits
+// arg[in]  grp     Digit grouping
+//
+// return number of characters put
+static int
+buf_put_grouped(char *buf, const char *digits, int n, group grp)
+{
+    char       *p       = buf;
+    char       *end     = buf + SCALAR_STR_MAX - 16;
+    int         g       = grp.digits();
+    char        sep     = grp.sep();
+    int         first   = n % g == 0 ? g : n % g;
+
+    memcpy(p, digits, first);
+    p += first;
+    digits += first;
+    n -= first;
+
+    while (n > 0)
+    {
+        *p++ = sep;
+        if (g <= 16 && p <= end)
+            memcpy(p, digits, 16);
+        else
+            memcpy(p, digits, g);
+        p += g;
+        digits += g;
+        n -= g;
+    }
+
+    return (int)(p - buf);
+}
+
 // Put integer value onto generic output.
-// Output format depends on specified binary type.
+// Output format depends on specified enumeration base type.
 //
 // arg[in] stream   Output stream, STDOUT or STDERR
 // arg[in] val      Scalar value
+// arg[in] grp      Digit grouping
 //
 // return: 0 - success, -1 - fault
 static int
-stream_put_int_gen(ostream &stream, scalar &val)
+stream_put_int_gen(ostream &stream, scalar &val, group grp)
+{
+    base_t      val_base    = val.val_base();
+#ifdef CONSOLEIO_SCALAR_CACHE
+    const char *buf;
+#else
+    char        buf[SCALAR_STR_MAX];
+#endif
+    int         len;
+
+    if ((int)val_base < 0 || (int)val_base >= (int)(base_t::BASE_INVAL))
+    {
+        cerr
+            << __FUNCTION__ << "() Enumeration base is invalid." << endl;
+        return -1;
+    }
+
+#ifdef CONSOLEIO_SCALAR_CACHE
+    len = val.cached_str(&buf, grp);
+#else
+    len = buf_put_scalar(buf, val, grp);
+#endif
+    if (len < 0)
+    {
+        cerr
+            << __FUNCTION__ << "() "
+            << "Integer value type is invalid." << endl;
+        return -1;
+    }
+
+    stream.write(buf, len);
+
+    return 0;
+}
+
+//////////////////////////////////////////////////////
+// Buffer I/O operations,                           //
+// see definitions in consoleio.h                   //
+//////////////////////////////////////////////////////
+
+// Get scalar value type corresponding given type name
+scalar_t
+scalar_str2type(const char *val)
 {
-    scalar_t    val_type        = val.val_type();
-    base_t      val_base        = val.val_base();
+    if (val == 0)
+        return scalar_t::TYPE_INVAL;
+
+    for (int i = 0; i < (int)scalar_t::TYPE_INTS; i++)
+    {
+        if (strcmp(val, scalar_name[i]) == 0)
+            return (scalar_t)i;
+    }
+
+    return scalar_t::TYPE_INVAL;
+}
+
+// Get size of integer value of given scalar type in bits
+int
+scalar_bits(scalar_t type)
+{
+    if ((int)type < 0 || (int)type >= (int)scalar_t::TYPE_INTS)
+        return -1;
+
+    return scalar_bits_n[(int)type];
+}
+
+// Cast integer value in raw form to given scalar type
+uint64_t
+raw_cast(uint64_t val, scalar_t type)
+{
+    int         bits    = scalar_bits(type);
+    uint64_t    mask;
+
+    if (bits < 0 || bits >= 64)
+        return val;
+
+    mask = bits_mask(bits);
+    val &= mask;
+    if (scalar_is_signed(type) && ((val >> (bits - 1)) & 1))
+        val |= ~mask;
+
+    return val;
+}
+
+// Put integer value into character buffer in string form
+int
+buf_put_int(char *buf, uint64_t val, scalar_t type, base_t base, group grp)
+{
+    int     bits    = scalar_bits(type);
+    int     g       = grp.digits();
+    char    digits[SCALAR_STR_MAX + 16];
+    int     len     = 0;
+    int     n;
+
+    // Base indexes lookup tables of all paths below
+    if (bits < 0 || (int)base >= (int)base_t::BASE_INVAL)
+        return -1;
+
+    if (bits <= 16 && g <= 0 &&
+        lut_io::lut_on.load(memory_order_relaxed))
+    {
+        n = lut_io::buf_put_int(buf, raw_cast(val, type), bits,
+                                scalar_is_signed(type), base);
+        if (n > 0)
+            return n;
+    }
 
-    switch (val_base)
+    if (g <= 0)
+    {
+        cpu_put_fn put = cpu_put_kernel(type, base);
+
+        if (put != nullptr)
+            return put(buf, val);
+    }
+
+    switch (base)
     {
         case base_t::BASE_BIN:
-            return bin_out::stream_put_int_gen(stream, val);
+            val &= bits_mask(bits);
+            if (g <= 0 || g >= bits)
+                return bin_out::buf_put_int(buf, val, bits);
+            if (g == 4 || g == 8)
+                return bin_out::buf_put_grouped(buf, val, bits, grp);
+            n = bin_out::buf_put_int(digits, val, bits);
+            break;
         case base_t::BASE_OCT:
-            return oct_out::stream_put_int_gen(stream, val);
+            val &= bits_mask(bits);
+            n = base_w_type[(int)type >> 1][(int)base];
+            if (g <= 0 || g >= n)
+                return oct_out::buf_put_int(buf, val, n);
+            n = oct_out::buf_put_int(digits, val, n);
+            break;
         case base_t::BASE_HEX:
-            return hex_out::stream_put_int_gen(stream, val);
+            val &= bits_mask(bits);
+            n = base_w_type[(int)type >> 1][(int)base];
+            if (g <= 0 || g >= n)
+                return hex_out::buf_put_int(buf, val, n);
+            n = hex_out::buf_put_int(digits, val, n);
+            break;
         case base_t::BASE_DEC:
+            val = raw_cast(val, type);
+            if (scalar_is_signed(type) && (int64_t)val < 0)
+            {
+                buf[len++] = '-';
+                val = 0 - val;
+            }
+            if (g <= 0)
+                return len + dec_out::buf_put_int(buf + len, val);
+            n = dec_out::buf_put_int(digits, val);
             break;
         default:
-            cerr
-                << __FUNCTION__ << "() Enumeration base is invalid." << endl;
             return -1;
     }
 
-    // Decimal value type is here
-    switch (val_type) {
-        case scalar_t::TYPE_BYTE:
-        case scalar_t::TYPE_SHORT:
-        case scalar_t::TYPE_LONG:
-            stream << val.val_l();
-            break;
-        case scalar_t::TYPE_UBYTE:
-        case scalar_t::TYPE_USHORT:
-        case scalar_t::TYPE_ULONG:
-            stream << val.val_ul();
-            break;
-        case scalar_t::TYPE_DOUBLE:
-            stream << val.val_d();
-            break;
-        case scalar_t::TYPE_UDOUBLE:
-            stream << val.val_ud();
-            break;
+    return len + buf_put_grouped(buf + len, digits, n, grp);
+}
+int
+buf_put_scalar(char *buf, scalar &val, group grp)
+{
+#ifdef CONSOLEIO_SCALAR_CACHE
+    const char *str;
+    int         len = val.cached_str(&str, grp);
+
+    if (len > 0)
+        memcpy(buf, str, len);
+
+    return len;
+#else
+    return buf_put_int(buf, val.val_raw(), val.val_type(), val.val_base(),
+                       grp);
+#endif
+}
+
+// Get integer value from string form
+int
+buf_get_int(const char *str, size_t len,
+            scalar_t type, base_t base, uint64_t &val)
+{
+    const char *p       = str;
+    const char *end     = str + len;
+    int         bits    = scalar_bits(type);
+    bool        neg     = false;
+    uint64_t    acc     = 0;
+    uint64_t    lim;
+    unsigned    shift;
+    cpu_get_fn  get;
+
+    if (bits < 0 || str == 0)
+        return -1;
+
+    if ((len == 2 || len == 4) && base == base_t::BASE_HEX &&
+        lut_io::lut_on.load(memory_order_relaxed))
+    {
+        long v = lut_io::buf_get_hex(str, len);
+
+        if (v >= 0 && (uint64_t)v <= bits_mask(bits))
+        {
+            val = raw_cast((uint64_t)v, type);
+            return 0;
+        }
+    }
+
+    get = cpu_get_kernel(type, base);
+    if (get != nullptr && get(str, len, val) == 0)
+        return 0;
+
+    if (p < end && (*p == '-' || *p == '+'))
+        neg = (*p++ == '-');
+
+    if (base == base_t::BASE_HEX && end - p > 2 &&
+        p[0] == '0' && (p[1] | 0x20) == 'x')
+        p += 2;
+
+    if (p == end)
+        return -1;
+
+    switch (base)
+    {
+        case base_t::BASE_BIN:  shift = 1;  break;
+        case base_t::BASE_OCT:  shift = 3;  break;
+        case base_t::BASE_HEX:  shift = 4;  break;
+        case base_t::BASE_DEC:  shift = 0;  break;
         default:
-            cerr
-                << __FUNCTION__ << "() "
-                << "Integer value type is invalid." << endl;
             return -1;
     }
 
+    if (shift != 0)
+    {
+        // Power of 2 enumeration bases:
+        // any bit pattern of the type size is valid
+        unsigned basis = 1u << shift;
+
+        for (; p < end; p++)
+        {
+            unsigned d = digit_val((unsigned char)*p);
+
+            if (d >= basis || (acc >> (64 - shift)) != 0)
+                return -1;
+            acc = (acc << shift) | d;
+        }
+
+        if (acc > bits_mask(bits))
+            return -1;
+    }
+    else
+    {
+        for (; p < end; p++)
+        {
+            unsigned d = digit_val((unsigned char)*p);
+
+            if (d >= 10 || acc > (~(uint64_t)0 - d) / 10)
+                return -1;
+            acc = acc * 10 + d;
+        }
+
+        // Decimal values must fit the range of the type
+        if (scalar_is_signed(type))
+            lim = ((uint64_t)1 << (bits - 1)) - (neg ? 0 : 1);
+        else
+            lim = neg ? 0 : bits_mask(bits);
+
+        if (acc > lim)
+            return -1;
+    }
+
+    val = raw_cast(neg ? 0 - acc : acc, type);
+
     return 0;
 }
+int
+buf_get_scalar(const char *str, size_t len, scalar &val)
+{
+    uint64_t raw;
+
+    if (buf_get_int(str, len, val.val_type(), val.val_base(), raw) != 0)
+        return -1;
+
+    val.set_raw(raw, val.val_type());
+
+    return 0;
+}
+
+// Enable or disable lookup tables of 8-bit and 16-bit values
+void
+buf_lut_enable(bool enable)
+{
+    if (enable)
+        call_once(lut_io::lut_once, lut_io::build);
+
+    lut_io::lut_on.store(enable);
+}
 
 //////////////////////////////////////////////////////
 // Class 'base' methods and operators.              //
@@ -443,17 +980,17 @@ stream_put_int_gen(ostream &stream, scalar &val)
 const char*
 base::name(void)
 {
-    return base_name[base_type_i];
+    return base_name[(int)base_type];
 }
 
 // Get printable width constants
 // for given enumeration base type and various
 // types of integer values.
-#define BASE_GET_CONST(_field) \
-int                                     \
-base::_field(void)                      \
-{                                       \
-    return base_##_field[base_type_i];  \
+#define BASE_GET_CONST(_field)                  \
+int                                             \
+base::_field(void)                              \
+{                                               \
+    return base_##_field[(int)base_type];       \
 }
 BASE_GET_CONST(basis)
 BASE_GET_CONST(w_char)
@@ -467,13 +1004,6 @@ BASE_GET_CONST(w_double)
 // Assign enumeration base type taken from
 // source value of various types.
 base_t
-base::operator=(base &val)
-{
-    base_type = val.type();
-    base_type_i = (int)base_type;
-    return base_type;
-}
-base_t
 base::operator=(base_t val)
 {
     if ((int)val < 0 || (int)val >= (int)(base_t::BASE_INVAL))
@@ -484,7 +1014,6 @@ base::operator=(base_t val)
     }
 
     base_type = val;
-    base_type_i = (int)val;
 
     return base_type;
 }
@@ -499,7 +1028,6 @@ base::operator=(int val)
     }
 
     base_type = (base_t)val;
-    base_type_i = val;
 
     return base_type;
 }
@@ -511,7 +1039,6 @@ base::operator=(const char *val)
     if ((int)rc >= 0 && (int)rc < (int)(base_t::BASE_INVAL))
     {
         base_type = rc;
-        base_type_i = (int)rc;
     }
     else
     {
@@ -529,94 +1056,78 @@ base::operator=(const char *val)
 // see definition in consoleio.h                    //
 //////////////////////////////////////////////////////
 
-// Constructor
-scalar::scalar(scalar_t val_type, base_t val_base) : \
-               scalar_type(val_type)                    \
-{                                                       \
-    enum_base = val_base;                               \
-}
-
-// Get scalar value type
-scalar_t
-scalar::val_type(void)
+// Report invalid scalar value type in accessor
+void
+scalar_type_inval(const char *fn)
 {
-    return scalar_type;
+    cerr << fn << ": Value type is invalid." << endl;
 }
 
-// Get enumeration base type
-base_t
-scalar::val_base(void)
-{
-    return enum_base.type();
-}
-
-// Get enumeration base type index
-int
-scalar::val_base_i(void)
+// Report invalid enumeration base in constructor
+void
+scalar_base_inval(const char *fn)
 {
-    return enum_base.type_i();
+    cerr << fn << ": Enumeration base is invalid." << endl;
 }
 
-// Get scalar value cast to various
-// integer types.
-long
-scalar::val_l(void)
+// Assign scalar value and scalar type from raw form
+void
+scalar::set_raw(uint64_t val, scalar_t type)
 {
-    switch (scalar_type)
+    switch (type)
     {
-        case scalar_t::TYPE_BYTE:
-            return (long)(*((int8_t *)scalar_val));
-        case scalar_t::TYPE_SHORT:
-            return (long)(*((int16_t *)scalar_val));
-        case scalar_t::TYPE_LONG:
-            return (long)(*((int32_t *)scalar_val));
+        case scalar_t::TYPE_BYTE:       *this = (int8_t)val;    break;
+        case scalar_t::TYPE_SHORT:      *this = (int16_t)val;   break;
+        case scalar_t::TYPE_LONG:       *this = (int32_t)val;   break;
+        case scalar_t::TYPE_DOUBLE:     *this = (int64_t)val;   break;
+        case scalar_t::TYPE_UBYTE:      *this = (uint8_t)val;   break;
+        case scalar_t::TYPE_USHORT:     *this = (uint16_t)val;  break;
+        case scalar_t::TYPE_ULONG:      *this = (uint32_t)val;  break;
+        case scalar_t::TYPE_UDOUBLE:    *this = (uint64_t)val;  break;
         default:
             cerr
-                << "scalar.val_l(): Value type is invalid." << endl;
+                << "scalar.set_raw(): Value type is invalid." << endl;
     }
-    return -1;
 }
-unsigned long
-scalar::val_ul(void)
-{
-    switch (scalar_type)
-    {
-        case scalar_t::TYPE_UBYTE:
-            return (unsigned long)(*((uint8_t *)scalar_val));
-        case scalar_t::TYPE_USHORT:
-            return (unsigned long)(*((uint16_t *)scalar_val));
-        case scalar_t::TYPE_ULONG:
-            return (unsigned long)(*((uint32_t *)scalar_val));
-        default:
-            cerr
-                << "scalar.val_ul(): Value type is invalid." << endl;
-    }
-    return (unsigned long)-1;
-}
-long long
-scalar::val_d(void)
+
+#ifdef CONSOLEIO_SCALAR_CACHE
+// Get string representation of scalar value from the cache
+int
+scalar::cached_str(const char **str, group grp)
 {
-    if (scalar_type == scalar_t::TYPE_DOUBLE)
-        return (long long)(*((int64_t *)scalar_val));
+    uint64_t    val     = val_raw();
+    base_t      base    = enum_base.type();
+    int         len;
 
-    cerr << "scalar.val_d(): Value type is invalid." << endl;
+    if (cache_len == 0 || cache_val != val || cache_type != scalar_type ||
+        cache_base != base || cache_digits != grp.digits() ||
+        cache_sep != grp.sep())
+    {
+        len = buf_put_int(cache_str, val, scalar_type, base, grp);
+        if (len <= 0)
+        {
+            cache_len = 0;
+            return -1;
+        }
 
-    return -1;
-}
-unsigned long long
-scalar::val_ud(void)
-{
-    if (scalar_type == scalar_t::TYPE_UDOUBLE)
-        return (unsigned long long)(*((uint64_t *)scalar_val));
+        cache_len = (uint8_t)len;
+        cache_val = val;
+        cache_type = scalar_type;
+        cache_base = base;
+        cache_digits = grp.digits();
+        cache_sep = grp.sep();
+    }
 
-    cerr << "scalar.val_ud(): Value type is invalid." << endl;
+    *str = cache_str;
 
-    return (unsigned long long)-1;
+    return cache_len;
 }
+#endif
 
 // Get pointer to scalar value.
 // Pointer must be cast to one of listed types
-// appropriate to scalar value type:
+// appropriate to scalar value type (the value is
+// in the low bytes of 64-bit word in host order):
 //
 // TYPE_BYTE    - (int8_t *)
 // TYPE_SHORT   - (int16_t *)
@@ -633,13 +1144,19 @@ scalar::val_ptr(void)
 }
 
 // Scalar class operators
+#ifdef CONSOLEIO_SCALAR_CACHE
+#define SCALAR_CACHE_RESET() cache_reset()
+#else
+#define SCALAR_CACHE_RESET()
+#endif
 #define SCALAR_OPERATOR_ASSIGN(_int_type, _scalar_type) \
 _int_type                                               \
 scalar::operator=(_int_type val)                        \
 {                                                       \
-    *((_int_type *)scalar_val) = val;                   \
+    scalar_val[0] = (uint64_t)val;                      \
     scalar_type = scalar_t::TYPE_##_scalar_type;        \
-    return *((_int_type *)scalar_val);                  \
+    SCALAR_CACHE_RESET();                               \
+    return val;                                         \
 }
 SCALAR_OPERATOR_ASSIGN(uint8_t, UBYTE)
 SCALAR_OPERATOR_ASSIGN(uint16_t, USHORT)
@@ -650,6 +1167,7 @@ SCALAR_OPERATOR_ASSIGN(int16_t, SHORT)
 SCALAR_OPERATOR_ASSIGN(int32_t, LONG)
 SCALAR_OPERATOR_ASSIGN(int64_t, DOUBLE)
 #undef SCALAR_OPERATOR_ASSIGN
+#undef SCALAR_CACHE_RESET
 
 //////////////////////////////////////////////////////
 // Class stream methods and operators.              //
@@ -657,7 +1175,7 @@ SCALAR_OPERATOR_ASSIGN(int64_t, DOUBLE)
 //////////////////////////////////////////////////////
 
 // Right shift operator: get scalar values
-// from console input
+// from console input or shared memory ring
 //
 // arg[out] val Scalar value to get
 //
@@ -666,6 +1184,9 @@ int
 stream::operator>>(scalar &val)
 {
 
+    if (stream_type == stream_t::STREAM_SHM && stream_ring != nullptr)
+        return stream_ring->pop(val);
+
     if (stream_type != STDIN)
     {
         cerr << "Stream operator >> : Stream must be input stream." << endl;
@@ -690,12 +1211,154 @@ stream::operator<<(scalar &val)
         return -1;
     }
 
+    if ((int)val.val_base() < 0 ||
+        (int)val.val_base() >= (int)(base_t::BASE_INVAL))
+    {
+        cerr << "Stream operator << : Enumeration base is invalid." << endl;
+        return -1;
+    }
+
     if (stream_type == STDOUT)
-        return stream_put_int_gen(cout, val);
+        return stream_put_int_gen(cout, val, stream_group[val.val_base_i()]);
     else if (stream_type == STDERR)
-        return stream_put_int_gen(cerr, val);
+        return stream_put_int_gen(cerr, val, stream_group[val.val_base_i()]);
+    else if (stream_type == stream_t::STREAM_SHM && stream_ring != nullptr)
+        return stream_ring->push(val);
     else
         cerr << "Stream operator << : Stream must be output stream." << endl;
 
     return -1;
 }
+
+// Read block of raw input from input stream. Console input
+// is read through C stream shared with 'cin', so block reads
+// may be mixed with operator >>.
+long long
+stream::read(char *buf, size_t len)
+{
+    size_t n;
+
+    if (stream_type != STDIN)
+    {
+        cerr << "stream.read(): Stream must be input stream." << endl;
+        return -1;
+    }
+
+    n = fread(buf, 1, len, stdin);
+    if (n < len && ferror(stdin))
+    {
+        cerr << "stream.read(): Failed to read input." << endl;
+        return -1;
+    }
+
+    return (long long)n;
+}
+
+// Write buffered output
+void
+stream::flush(void)
+{
+    if (stream_type == STDOUT)
+        cout.flush();
+    else if (stream_type == STDERR)
+        cerr.flush();
+    else if (stream_type == stream_t::STREAM_SHM && stream_ring != nullptr)
+        stream_ring->flush();
+}
+
+// Set digit grouping for given enumeration base
+//
+// return 0 on success, -1 on fault
+int
+stream::set_group(base_t base, group grp)
+{
+    if ((int)base < 0 || (int)base >= (int)(base_t::BASE_INVAL))
+    {
+        cerr << "stream.set_group(): Enumeration base is invalid." << endl;
+        return -1;
+    }
+
+    if (grp.digits() < 0 || grp.digits() > BASE_BIN_W_DOUBLE)
+    {
+        cerr << "stream.set_group(): Number of digits is invalid." << endl;
+        return -1;
+    }
+
+    stream_group[(int)base] = grp;
+
+    return 0;
+}
+
+// Put array of integer values in raw form onto output stream.
+// Values are put into a chunk buffer which is written
+// onto the stream when it is full. Shared memory ring
+// gets chunks of scalar values, the separator is unused.
+//
+// return 0 on success, -1 on fault
+int
+stream::put_array(const uint64_t *vals, size_t n,
+                  scalar_t type, base_t base, char sep)
+{
+    const size_t    chunk   = 1 << 16;
+    ostream        *out     = nullptr;
+    group           grp;
+    char           *buf;
+    size_t          pos     = 0;
+
+    if (stream_type == STDOUT)
+        out = &cout;
+    else if (stream_type == STDERR)
+        out = &cerr;
+    else if (stream_type != stream_t::STREAM_SHM || stream_ring == nullptr)
+    {
+        cerr << "stream.put_array(): Stream must be output stream." << endl;
+        return -1;
+    }
+
+    if (scalar_bits(type) < 0 ||
+        (int)base < 0 || (int)base >= (int)(base_t::BASE_INVAL))
+    {
+        cerr << "stream.put_array(): Value type or base is invalid." << endl;
+        return -1;
+    }
+
+    if (out == nullptr)
+    {
+        scalar  batch[SHM_BATCH];
+        int     rc      = 0;
+
+        for (size_t i = 0; i < n && rc == 0; i += SHM_BATCH)
+        {
+            size_t k = n - i < SHM_BATCH ? n - i : SHM_BATCH;
+
+            for (size_t j = 0; j < k; j++)
+            {
+                batch[j] = scalar(type, base);
+                batch[j].set_raw(vals[i + j], type);
+            }
+            rc = stream_ring->put(batch, k);
+        }
+
+        return rc;
+    }
+
+    grp = stream_group[(int)base];
+    buf = new char[chunk + SCALAR_STR_MAX + 1];
+
+    for (size_t i = 0; i < n; i++)
+    {
+        pos += buf_put_int(buf + pos, vals[i], type, base, grp);
+        buf[pos++] = sep;
+
+        if (pos >= chunk)
+        {
+            out->write(buf, pos);
+            pos = 0;
+        }
+    }
+    out->write(buf, pos);
+
+    delete[] buf;
+
+    return 0;
+}
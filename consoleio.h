@@ -6,6 +6,9 @@
 #ifndef HAVE_CONSOLEIO_H
 #define HAVE_CONSOLEIO_H
 #include <iostream>
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
 
 //////////////////////////////////////////////////////////////
 // Global library defines                                   //
@@ -23,22 +26,59 @@
 // Default enumeration basis - 10, decimal enumeration base
 #define BASE_DFLT_N base_n::BASE_DEC_N
 
+// Scalar value type names in string form
+#define TYPE_BYTE_S     "byte"
+#define TYPE_UBYTE_S    "ubyte"
+#define TYPE_SHORT_S    "short"
+#define TYPE_USHORT_S   "ushort"
+#define TYPE_LONG_S     "long"
+#define TYPE_ULONG_S    "ulong"
+#define TYPE_DOUBLE_S   "double"
+#define TYPE_UDOUBLE_S  "udouble"
+
 // Default value type for scalar value, 'long' integer
 #define SCALAR_DFLT scalar_t::TYPE_LONG
 
+// Define CONSOLEIO_SCALAR_CACHE to make scalar values keep
+// their string representation between outputs, so unchanged
+// values are put onto streams without formatting.
+// Scalar objects grow by the cache size then.
+//#define CONSOLEIO_SCALAR_CACHE
+
+// Maximal number of characters in string representation
+// of scalar value of any type in any enumeration base
+// (binary 'long long' value split into groups of single
+// digit is the longest one).
+// Character buffers for buffer I/O operations must
+// be at least of this size.
+#define SCALAR_STR_MAX  128
+
+// Default separator of digit groups
+#define GROUP_SEP_DFLT  '_'
+
+// Commonly used digit groupings
+#define GROUP_NONE      group()
+#define GROUP_NIBBLE    group(4)        // Binary nibbles, hexadecimal words
+#define GROUP_BYTE      group(8)        // Binary bytes
+#define GROUP_HEX_BYTE  group(2, '\'')  // Hexadecimal bytes
+#define GROUP_THOUSANDS group(3, ',')   // Decimal thousands
+
 // I/0 streams and default stream
 #define STDIN       stream_t::STREAM_STDIN
 #define STDOUT      stream_t::STREAM_STDOUT
 #define STDERR      stream_t::STREAM_STDERR
 #define STREAM_DFLT STDIN
 
+// Default number of slots of shared memory ring
+#define SHM_RING_DFLT   (1 << 16)
+
 //////////////////////////////////////////////////////////////
 // Global library data types                                //
 //////////////////////////////////////////////////////////////
 
 // Enumeration base type for string representation
 // of integer values in console I/O operations.
-enum class base_t
+enum class base_t : uint8_t
 {
     BASE_BIN = 0,   // Binary
     BASE_OCT,       // Octal
@@ -54,25 +94,23 @@ typedef class base
     private:
         base_t  base_type;      // Enumeration
                                 // base type.
-        int     base_type_i;    // Enumeration
-                                // base type index.
     public:
         // Constructor
         // arg[in] type Enumeration base type.
-        base(base_t type = BASE_DFLT) : \
-            base_type(type), base_type_i((int)type) {};
+        constexpr base(base_t type = BASE_DFLT) : \
+            base_type(type) {};
         // Get base type in the form of
         // base type enumeration class and
         // in the form of an integer value.
-        base_t
-        type(void)
+        constexpr base_t
+        type(void) const
         {
             return base_type;
         }
-        int
-        type_i(void)
+        constexpr int
+        type_i(void) const
         {
-            return base_type_i;
+            return (int)base_type;
         }
         // Get enumeration base type name.
         const char *name(void);
@@ -87,15 +125,45 @@ typedef class base
         int         w_double(void);
         // Assignment operators.
         // Assign enumeration base type
-        base_t operator=(base &val);
+        base &operator=(const base &val) = default;
         base_t operator=(base_t val);
         base_t operator=(int val);
         base_t operator=(const char *val);
 } base;
 
+// Class to represent grouping of digits in string
+// representation of integer values. Digits are split into
+// groups from the least significant one, the most
+// significant group may be shorter than others.
+typedef class group
+{
+    private:
+        int     group_digits;   // Number of digits in group,
+                                // 0 - no grouping.
+        char    group_sep;      // Group separator.
+    public:
+        // Constructor
+        // arg[in] digits   Number of digits in group
+        // arg[in] sep      Group separator
+        group(int digits = 0, char sep = GROUP_SEP_DFLT) : \
+            group_digits(digits), group_sep(sep) {};
+        // Get number of digits in group
+        int
+        digits(void)
+        {
+            return group_digits;
+        }
+        // Get group separator
+        char
+        sep(void)
+        {
+            return group_sep;
+        }
+} group;
+
 // Scalar value type for string representation
 // of integer values in console I/O operations.
-enum class scalar_t
+enum class scalar_t : uint8_t
 {
     TYPE_BYTE = 0,  // int8_t, char
     TYPE_UBYTE,     // uint8_t, unsigned char
@@ -110,31 +178,79 @@ enum class scalar_t
     TYPE_INVAL = TYPE_INTS,
 };
 
+// Report invalid scalar value type in accessor
+// and invalid enumeration base in constructor
+//
+// arg[in] fn   Accessor name
+void        scalar_type_inval(const char *fn);
+void        scalar_base_inval(const char *fn);
+
 // Class to represent scalar values of various integer
-// types and enumeration base types
+// types and enumeration base types. Value data is kept
+// in the low bytes of 64-bit payload, scalar type and
+// enumeration base take a byte each, so the object is
+// 16 bytes large and trivially copyable.
 typedef class scalar
 {
     private:
-        // Scaler value data
-        // Location space is enough to place
-        // any scalar value from
-        // uint8_t to long double
-        uint8_t     scalar_val[16] = {0,};
+        // Scalar value data, the value of scalar
+        // type is in the low bytes of the first
+        // word. Wide payload has space to place
+        // any scalar value up to long double.
+#ifdef CONSOLEIO_SCALAR_WIDE
+        uint64_t    scalar_val[2] = {0,};
+#else
+        uint64_t    scalar_val[1] = {0,};
+#endif
         // Scalar value type
         scalar_t    scalar_type;
+#ifdef CONSOLEIO_SCALAR_CACHE
+        // Cached string representation of scalar value
+        // and the key it has been formatted with.
+        char        cache_str[SCALAR_STR_MAX];
+        uint8_t     cache_len = 0;  // 0 - cache is empty
+        scalar_t    cache_type;
+        base_t      cache_base;
+        int         cache_digits;
+        char        cache_sep;
+        uint64_t    cache_val;
+#endif
     public:
         // Enumeration base
         base        enum_base;
+        // Constructor, invalid enumeration base
+        // is replaced by the default one.
         //
-        // arg[in] val_type     Scalar value
-        scalar(scalar_t val_type = SCALAR_DFLT,
-               base_t val_base = BASE_DFLT);
+        // arg[in] val_type     Scalar value type
+        // arg[in] val_base     Enumeration base type
+        constexpr scalar(scalar_t val_type = SCALAR_DFLT,
+                         base_t val_base = BASE_DFLT) : \
+            scalar_type(val_type), enum_base(val_base)
+        {
+            if ((int)val_base >= (int)base_t::BASE_INVAL)
+            {
+                enum_base = base(BASE_DFLT);
+                scalar_base_inval("scalar.scalar()");
+            }
+        }
         // Get scalar value type
-        scalar_t    val_type(void);
+        constexpr scalar_t
+        val_type(void) const
+        {
+            return scalar_type;
+        }
         // Get enumeration base type
-        base_t      val_base(void);
+        constexpr base_t
+        val_base(void) const
+        {
+            return enum_base.type();
+        }
         // Get enumeration base type index
-        int         val_base_i(void);
+        constexpr int
+        val_base_i(void) const
+        {
+            return enum_base.type_i();
+        }
         // Get pointer to scalar value
         void*       val_ptr(void);
         // Get scalar value cast to
@@ -143,14 +259,114 @@ typedef class scalar
         // return scalar value cast to
         // integer type on success or
         // -1 cast to integer type on fault
-        long                val_l(void);
-        long long           val_d(void);
-        unsigned long       val_ul(void);
-        unsigned long long  val_ud(void);
+        constexpr long
+        val_l(void) const
+        {
+            switch (scalar_type)
+            {
+                case scalar_t::TYPE_BYTE:
+                    return (long)(int8_t)scalar_val[0];
+                case scalar_t::TYPE_SHORT:
+                    return (long)(int16_t)scalar_val[0];
+                case scalar_t::TYPE_LONG:
+                    return (long)(int32_t)scalar_val[0];
+                default:
+                    scalar_type_inval("scalar.val_l()");
+            }
+            return -1;
+        }
+        constexpr long long
+        val_d(void) const
+        {
+            if (scalar_type == scalar_t::TYPE_DOUBLE)
+                return (long long)(int64_t)scalar_val[0];
+
+            scalar_type_inval("scalar.val_d()");
+            return -1;
+        }
+        constexpr unsigned long
+        val_ul(void) const
+        {
+            switch (scalar_type)
+            {
+                case scalar_t::TYPE_UBYTE:
+                    return (unsigned long)(uint8_t)scalar_val[0];
+                case scalar_t::TYPE_USHORT:
+                    return (unsigned long)(uint16_t)scalar_val[0];
+                case scalar_t::TYPE_ULONG:
+                    return (unsigned long)(uint32_t)scalar_val[0];
+                default:
+                    scalar_type_inval("scalar.val_ul()");
+            }
+            return (unsigned long)-1;
+        }
+        constexpr unsigned long long
+        val_ud(void) const
+        {
+            if (scalar_type == scalar_t::TYPE_UDOUBLE)
+                return (unsigned long long)scalar_val[0];
+
+            scalar_type_inval("scalar.val_ud()");
+            return (unsigned long long)-1;
+        }
+        // Get scalar value in raw form
+        // (see buffer I/O operations below)
+        constexpr uint64_t
+        val_raw(void) const
+        {
+            switch (scalar_type)
+            {
+                case scalar_t::TYPE_BYTE:
+                    return (uint64_t)(int64_t)(int8_t)scalar_val[0];
+                case scalar_t::TYPE_SHORT:
+                    return (uint64_t)(int64_t)(int16_t)scalar_val[0];
+                case scalar_t::TYPE_LONG:
+                    return (uint64_t)(int64_t)(int32_t)scalar_val[0];
+                case scalar_t::TYPE_UBYTE:
+                    return (uint64_t)(uint8_t)scalar_val[0];
+                case scalar_t::TYPE_USHORT:
+                    return (uint64_t)(uint16_t)scalar_val[0];
+                case scalar_t::TYPE_ULONG:
+                    return (uint64_t)(uint32_t)scalar_val[0];
+                case scalar_t::TYPE_DOUBLE:
+                case scalar_t::TYPE_UDOUBLE:
+                    return scalar_val[0];
+                default:
+                    scalar_type_inval("scalar.val_raw()");
+            }
+            return (uint64_t)-1;
+        }
+        // Assign scalar value and scalar type
+        // from raw form of integer value.
+        //
+        // arg[in] val  Raw integer value
+        // arg[in] type Scalar value type
+        void                set_raw(uint64_t val, scalar_t type);
+#ifdef CONSOLEIO_SCALAR_CACHE
+        // Get string representation of scalar value from
+        // the cache, the value is formatted and cached
+        // if the cache is empty or was filled with another
+        // value, type, enumeration base or digit grouping.
+        //
+        // arg[out] str Cached string, not zero-terminated
+        // arg[in]  grp Digit grouping
+        //
+        // return string length on success, -1 on fault
+        int                 cached_str(const char **str, group grp);
+        // Drop cached string representation
+        void
+        cache_reset(void)
+        {
+            cache_len = 0;
+        }
+#endif
         // Assign the type of scalar value
         scalar_t        operator=(scalar_t type)
         {
             scalar_type = type;
+#ifdef CONSOLEIO_SCALAR_CACHE
+            cache_reset();
+#endif
             return scalar_type;
         }
         // Assign scalar value and scalar type
@@ -165,25 +381,114 @@ typedef class scalar
         int64_t         operator=(int64_t val);
 } scalar;
 
+// Scalar values are copied as plain memory
+static_assert(std::is_trivially_copyable<scalar>::value,
+              "scalar must be trivially copyable");
+#ifndef CONSOLEIO_SCALAR_CACHE
+#ifdef CONSOLEIO_SCALAR_WIDE
+static_assert(sizeof(scalar) == 24, "wide scalar must be 24 bytes");
+#else
+static_assert(sizeof(scalar) == 16, "scalar must be 16 bytes");
+#endif
+#endif
+
 // I/O stream type
 enum class stream_t
 {
     STREAM_STDIN = 0,   // STDIN
     STREAM_STDOUT,      // STDOUT
     STREAM_STDERR,      // STDERR
+    STREAM_SHM,         // Shared memory ring, see open_shm()
     STREAM_INVAL,
 };
 
+// Shared memory ring of scalar values (see consoleio_shm.h)
+class shm_ring;
+
 // Class to represent various types of I/O
 // stream with appropriate I/O operators
 // for various types of I/O data.
 typedef class stream {
 private:
     stream_t stream_type;
+    // Digit grouping for each enumeration base
+    group    stream_group[(int)base_t::BASE_INVAL];
+    // Attached ring of STREAM_SHM stream
+    shm_ring *stream_ring;
 public:
     // Constructor
     stream(stream_t type = STREAM_DFLT) : \
-        stream_type(type) {};
+        stream_type(type), stream_ring(nullptr) {};
+    ~stream();
+    stream(const stream &) = delete;
+    stream &operator=(const stream &) = delete;
+    // Create or attach named shared memory ring of scalar
+    // values and make it the stream (STREAM_SHM). Values
+    // are passed in native form: 'stream << scalar' puts
+    // them into the ring, 'stream >> scalar' gets them.
+    // Put values become visible to the other side by
+    // batches or after flush(), see consoleio_shm.h.
+    //
+    // arg[in] name     Shared memory object name, e.g. "/ring"
+    // arg[in] create   Whether the ring is created
+    // arg[in] capacity Number of ring slots of created ring
+    //
+    // return 0 on success, -1 on fault
+    int         open_shm(const char *name, bool create,
+                         size_t capacity = SHM_RING_DFLT);
+    // Detach shared memory ring, the putting side
+    // marks the end of values for the other side.
+    // The stream type becomes STREAM_INVAL then.
+    void        close_shm(void);
+    // Write buffered output, values put into shared
+    // memory ring are published.
+    void        flush(void);
+    // Set digit grouping used to put values
+    // in given enumeration base onto the stream.
+    //
+    // arg[in] base Enumeration base type
+    // arg[in] grp  Digit grouping, GROUP_NONE to disable
+    //
+    // return 0 on success, -1 on fault
+    int         set_group(base_t base, group grp);
+    // Put array of integer values in raw form onto
+    // output stream, each value is followed by separator.
+    //
+    // arg[in] vals Raw integer values
+    // arg[in] n    Number of values
+    // arg[in] type Scalar value type
+    // arg[in] base Enumeration base type
+    // arg[in] sep  Separator
+    //
+    // return 0 on success, -1 on fault
+    int         put_array(const uint64_t *vals, size_t n,
+                          scalar_t type, base_t base, char sep = '\n');
+    // Sort array of integer values in raw form with
+    // radix sort and put them onto output stream
+    // (see consoleio_sort.h).
+    //
+    // arg[in,out] vals     Raw integer values, sorted on return
+    // arg[in]     n        Number of values
+    // arg[in]     type     Scalar value type
+    // arg[in]     base     Enumeration base type
+    // arg[in]     unique   Whether duplicates are dropped
+    // arg[in]     threads  Number of sorting threads
+    // arg[in]     sep      Separator
+    //
+    // return 0 on success, -1 on fault
+    int         put_sorted(uint64_t *vals, size_t n,
+                           scalar_t type, base_t base,
+                           bool unique = false, int threads = 1,
+                           char sep = '\n');
+    // Read block of raw input from input stream,
+    // blocks until the block is full or input ends.
+    //
+    // arg[out] buf Input buffer
+    // arg[in]  len Buffer size
+    //
+    // return number of read bytes on success
+    // (0 at the end of input), -1 on fault
+    long long   read(char *buf, size_t len);
     // Assignment operator
     // Set necessary stream type through
     // assignment operator
@@ -195,17 +500,102 @@ public:
     // Left shift operator.
     //
     // Put data of various scalar types onto output stream
-    // (with stream_type == STOUT || stream_type == STDERR).
+    // (with stream_type == STOUT || stream_type == STDERR ||
+    // stream_type == STREAM_SHM).
     //
     // stream << scalar
     int             operator<<(scalar& val);
     // Right shift operator.
     //
     // Get data of various scalar types from input stream
-    // (with stream_type == STDIN).
+    // (with stream_type == STDIN || stream_type == STREAM_SHM),
+    // the end of shared memory values gives -1.
     //
     // stream >> scalar
     int             operator>>(scalar& val);
 } stream;
 
+//////////////////////////////////////////////////////////////
+// Buffer I/O operations                                    //
+//////////////////////////////////////////////////////////////
+// Integer values are passed to buffer I/O operations in    //
+// raw form: value of any scalar type held in 'uint64_t',   //
+// signed values are sign-extended to 64 bits.              //
+// No diagnostics are printed by these operations, so they  //
+// fit bulk conversion of large amounts of data.            //
+//////////////////////////////////////////////////////////////
+
+// Get scalar value type corresponding given type name
+// (see TYPE_*_S names).
+//
+// return scalar value type on success,
+// scalar_t::TYPE_INVAL on fault
+scalar_t    scalar_str2type(const char *val);
+
+// Get size of integer value of given scalar type in bits.
+//
+// return number of bits on success, -1 on fault
+int         scalar_bits(scalar_t type);
+
+// Check whether given scalar value type is signed one.
+// Signed types have even indexes in 'scalar_t'.
+inline bool
+scalar_is_signed(scalar_t type)
+{
+    return ((int)type & 1) == 0;
+}
+
+// Cast integer value in raw form to given scalar type:
+// value is truncated to the size of the type and
+// sign-extended back for signed types.
+uint64_t    raw_cast(uint64_t val, scalar_t type);
+
+// Put integer value into character buffer in string form.
+// Printable width and fulfill rules are the same as for
+// 'stream << scalar', no terminating zero is put.
+// Buffer contents beyond the put characters may be
+// overwritten up to SCALAR_STR_MAX characters.
+//
+// arg[out] buf     Character buffer, SCALAR_STR_MAX characters
+// arg[in]  val     Raw integer value
+// arg[in]  type    Scalar value type
+// arg[in]  base    Enumeration base type
+// arg[in]  grp     Digit grouping
+//
+// return number of characters put on success, -1 on fault
+int         buf_put_int(char *buf, uint64_t val,
+                        scalar_t type, base_t base,
+                        group grp = GROUP_NONE);
+int         buf_put_scalar(char *buf, scalar &val,
+                           group grp = GROUP_NONE);
+
+// Get integer value from string form. The whole string
+// must be a number: optional sign, optional '0x' prefix
+// for hexadecimal base and digits of enumeration base.
+// Decimal values must fit the range of scalar type,
+// other bases accept any bit pattern of the type size.
+//
+// arg[in]  str     String, not zero-terminated
+// arg[in]  len     String length
+// arg[in]  type    Scalar value type
+// arg[in]  base    Enumeration base type
+// arg[out] val     Raw integer value
+//
+// return 0 on success, -1 on fault
+int         buf_get_int(const char *str, size_t len,
+                        scalar_t type, base_t base, uint64_t &val);
+int         buf_get_scalar(const char *str, size_t len, scalar &val);
+
+// Enable or disable formatting of 8-bit and 16-bit values
+// through precomputed lookup tables: every 8-bit value in
+// all enumeration bases and every 16-bit value in
+// hexadecimal and decimal bases is put with a single fixed
+// size copy, 2 and 4 digit hexadecimal strings are got with
+// table lookups. Values put with digit grouping are not
+// covered. The tables (about 1 MiB) are built at the first
+// enabling and kept until the program exits.
+//
+// arg[in] enable   Whether lookup tables are used
+void        buf_lut_enable(bool enable);
+
 #endif //HAVE_CONSOLEIO_H
@@ -0,0 +1,543 @@
+#include "consoleio_agg.h"
+#include <thread>
+#include <cstring>
+#include <cmath>
+
+//////////////////////////////////////////////////////
+// Module global namespace                          //
+//////////////////////////////////////////////////////
+using namespace std;
+
+//////////////////////////////////////////////////////
+// Module global macros                             //
+//////////////////////////////////////////////////////
+// Order key of the sign bit: signed values are
+// compared as unsigned ones with inverted sign bit
+#define KEY_SIGN ((uint64_t)1 << 63)
+
+// Sketch bucket of zero value
+#define SKETCH_ZERO (AGG_SKETCH_HALF - 1)
+
+// Quantiles put in report
+static const double
+report_q[] = {0.5, 0.9, 0.99};
+
+//////////////////////////////////////////////////////
+// Module global functions                          //
+//////////////////////////////////////////////////////
+
+// Check whether character is whitespace separator
+static inline bool
+is_space(char c)
+{
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' ||
+           c == '\v' || c == '\f';
+}
+
+// Get number of significant bits of value
+static inline int
+bit_len(uint64_t val)
+{
+#ifdef _MSC_VER
+    unsigned long idx;
+
+    return _BitScanReverse64(&idx, val) ? (int)idx + 1 : 0;
+#else
+    return val == 0 ? 0 : 64 - __builtin_clzll(val);
+#endif
+}
+
+// Get sketch bucket offset of magnitude: magnitudes below
+// 2^AGG_SKETCH_BITS are offsets themselves, larger ones
+// are split by bit length and the next AGG_SKETCH_BITS
+// bits below the leading one.
+static inline int
+sketch_index(uint64_t mag)
+{
+    int shift = bit_len(mag) - 1 - AGG_SKETCH_BITS;
+
+    if (shift <= 0)
+        return (int)mag;
+
+    return (shift << AGG_SKETCH_BITS) + (int)(mag >> shift);
+}
+
+// Get bounds of magnitudes of sketch bucket offset,
+// see sketch_index()
+static inline void
+sketch_bounds(int idx, long double &lo, long double &hi)
+{
+    int shift = (idx >> AGG_SKETCH_BITS) - 1;
+
+    if (shift <= 0)
+    {
+        lo = hi = idx;
+        return;
+    }
+
+    idx -= shift << AGG_SKETCH_BITS;
+    lo = ldexpl(idx, shift);
+    hi = ldexpl(idx + 1, shift) - 1;
+}
+
+// Get sketch bucket of value: zero has the middle bucket,
+// positive and negative values go to buckets above and
+// below it by their magnitude.
+static inline int
+sketch_bucket(uint64_t val, bool sign)
+{
+    if (sign && (int64_t)val < 0)
+        return SKETCH_ZERO - sketch_index(0 - val);
+
+    return SKETCH_ZERO + sketch_index(val);
+}
+
+// Add value in raw form to 128-bit sum, signed values
+// are sign-extended. The sum of 2^64 values never
+// overflows, so partial sums may go out of 64-bit range
+// and back.
+static inline void
+sum_add(uint64_t &lo, uint64_t &hi, uint64_t val, bool sign)
+{
+    lo += val;
+    hi += (uint64_t)(lo < val) +
+          (sign ? (uint64_t)((int64_t)val >> 63) : 0);
+}
+
+//////////////////////////////////////////////////////
+// Class 'aggregate' methods,                       //
+// see definition in consoleio_agg.h                //
+//////////////////////////////////////////////////////
+
+// Constructor
+aggregate::aggregate(scalar_t type, base_t base) : \
+                     agg_type(type), agg_base(base)   \
+{
+    hist_lo = 0;
+    hist_hi = 0;
+    hist_bins = 0;
+    hist_scale = 0;
+    reset();
+}
+
+// Drop all collected values
+void
+aggregate::reset(void)
+{
+    agg_count = 0;
+    agg_errs = 0;
+    agg_min = ~(uint64_t)0;
+    agg_max = 0;
+    agg_sum = 0;
+    agg_sum_hi = 0;
+    tail_len = 0;
+    hist.assign(hist_bins > 0 ? hist_bins + 2 : AGG_SKETCH_BUCKETS, 0);
+}
+
+// Set uniform histogram
+int
+aggregate::set_histogram(int bins, uint64_t lo, uint64_t hi)
+{
+    uint64_t sign = scalar_is_signed(agg_type) ? KEY_SIGN : 0;
+
+    if (bins < 0 || (bins > 0 && (lo ^ sign) > (hi ^ sign)))
+    {
+        cerr
+            << "aggregate.set_histogram(): Histogram bounds are invalid."
+            << endl;
+        return -1;
+    }
+
+    hist_bins = bins;
+    hist_lo = lo ^ sign;
+    hist_hi = hi ^ sign;
+    hist_scale = (double)bins / ((double)(hist_hi - hist_lo) + 1);
+    reset();
+
+    return 0;
+}
+
+// Add block of text with complete tokens. Parsed values
+// are kept in local variables and never turned
+// into scalar objects.
+void
+aggregate::feed_block(const char *buf, size_t len)
+{
+    const char *p       = buf;
+    const char *end     = buf + len;
+    bool        sign    = scalar_is_signed(agg_type);
+    uint64_t    key_s   = sign ? KEY_SIGN : 0;
+    uint64_t    count   = agg_count;
+    uint64_t    errs    = agg_errs;
+    uint64_t    mn      = agg_min;
+    uint64_t    mx      = agg_max;
+    uint64_t    sum     = agg_sum;
+    uint64_t    sum_hi  = agg_sum_hi;
+    uint64_t   *h       = hist.data();
+    int         bins    = hist_bins;
+    uint64_t    lo      = hist_lo;
+    uint64_t    hi      = hist_hi;
+    double      scale   = hist_scale;
+
+    while (p < end)
+    {
+        const char *tok;
+        uint64_t    val;
+        uint64_t    key;
+
+        while (p < end && is_space(*p))
+            p++;
+        if (p == end)
+            break;
+
+        tok = p;
+        while (p < end && !is_space(*p))
+            p++;
+
+        if (buf_get_int(tok, p - tok, agg_type, agg_base, val) != 0)
+        {
+            errs++;
+            continue;
+        }
+
+        key = val ^ key_s;
+        count++;
+        mn = key < mn ? key : mn;
+        mx = key > mx ? key : mx;
+
+        sum_add(sum, sum_hi, val, sign);
+
+        if (bins == 0)
+            h[sketch_bucket(val, sign)]++;
+        else if (key < lo)
+            h[bins]++;
+        else if (key > hi)
+            h[bins + 1]++;
+        else
+        {
+            int i = (int)((double)(key - lo) * scale);
+
+            h[i < bins ? i : bins - 1]++;
+        }
+    }
+
+    agg_count = count;
+    agg_errs = errs;
+    agg_min = mn;
+    agg_max = mx;
+    agg_sum = sum;
+    agg_sum_hi = sum_hi;
+}
+
+// Add text to aggregation
+void
+aggregate::feed(const char *buf, size_t len)
+{
+    size_t head = 0;
+    size_t cut;
+
+    // Complete token kept from the previous text,
+    // negative length means too long token skipped
+    // up to the next whitespace.
+    if (tail_len != 0)
+    {
+        while (head < len && !is_space(buf[head]))
+            head++;
+
+        if (tail_len > 0 && tail_len + head < sizeof(tail))
+        {
+            memcpy(tail + tail_len, buf, head);
+            tail_len += (int)head;
+        }
+        else if (tail_len > 0)
+        {
+            agg_errs++;
+            tail_len = -1;
+        }
+
+        if (head == len)
+            return;
+
+        if (tail_len > 0)
+            feed_block(tail, tail_len);
+        tail_len = 0;
+    }
+
+    cut = len;
+    while (cut > head && !is_space(buf[cut - 1]))
+        cut--;
+
+    feed_block(buf + head, cut - head);
+
+    if (len - cut < sizeof(tail))
+    {
+        memcpy(tail, buf + cut, len - cut);
+        tail_len = (int)(len - cut);
+    }
+    else
+    {
+        agg_errs++;
+        tail_len = -1;
+    }
+}
+
+// Add text to aggregation with several threads
+void
+aggregate::feed_parallel(const char *buf, size_t len, int threads)
+{
+    vector<aggregate>   parts;
+    vector<thread>      workers;
+    size_t              head    = 0;
+    size_t              cut     = len;
+    size_t              beg;
+
+    if (threads <= 1)
+    {
+        feed(buf, len);
+        return;
+    }
+
+    // Token kept from the previous text and incomplete
+    // token at the end are added by this thread.
+    if (tail_len != 0)
+    {
+        while (head < len && !is_space(buf[head]))
+            head++;
+        if (head == len)
+        {
+            feed(buf, len);
+            return;
+        }
+        feed(buf, ++head);
+    }
+    while (cut > head && !is_space(buf[cut - 1]))
+        cut--;
+
+    parts.assign(threads, *this);
+    beg = head;
+    for (int i = 0; i < threads; i++)
+    {
+        size_t end = i == threads - 1 ? cut :
+                     head + (cut - head) * (i + 1) / threads;
+
+        while (end < cut && !is_space(buf[end]))
+            end++;
+        if (end < beg)
+            end = beg;
+
+        parts[i].reset();
+        workers.emplace_back(&aggregate::feed_block, &parts[i],
+                             buf + beg, end - beg);
+        beg = end;
+    }
+    for (auto &w : workers)
+        w.join();
+    for (auto &part : parts)
+        merge(part);
+
+    feed(buf + cut, len - cut);
+}
+
+// Add incomplete token kept at the end of text
+void
+aggregate::finish(void)
+{
+    if (tail_len > 0)
+        feed_block(tail, tail_len);
+    tail_len = 0;
+}
+
+// Merge partial aggregate
+int
+aggregate::merge(aggregate &part)
+{
+    if (part.agg_type != agg_type || part.hist_bins != hist_bins ||
+        part.hist_lo != hist_lo || part.hist_hi != hist_hi)
+    {
+        cerr
+            << "aggregate.merge(): Aggregate settings do not match." << endl;
+        return -1;
+    }
+
+    agg_count += part.agg_count;
+    agg_errs += part.agg_errs;
+    agg_min = part.agg_min < agg_min ? part.agg_min : agg_min;
+    agg_max = part.agg_max > agg_max ? part.agg_max : agg_max;
+    agg_sum += part.agg_sum;
+    agg_sum_hi += part.agg_sum_hi + (agg_sum < part.agg_sum);
+
+    for (size_t i = 0; i < hist.size(); i++)
+        hist[i] += part.hist[i];
+
+    return 0;
+}
+
+// Get minimal and maximal values in raw form
+uint64_t
+aggregate::min(void)
+{
+    return agg_min ^ (scalar_is_signed(agg_type) ? KEY_SIGN : 0);
+}
+uint64_t
+aggregate::max(void)
+{
+    return agg_max ^ (scalar_is_signed(agg_type) ? KEY_SIGN : 0);
+}
+
+// Get sum of values
+int
+aggregate::sum(uint64_t &val)
+{
+    uint64_t hi = scalar_is_signed(agg_type) ?
+                  (uint64_t)((int64_t)agg_sum >> 63) : 0;
+
+    val = agg_sum;
+
+    return agg_sum_hi == hi ? 0 : -1;
+}
+
+// Get mean value
+double
+aggregate::mean(void)
+{
+    if (agg_count == 0)
+        return 0;
+
+    long double hi = scalar_is_signed(agg_type) ?
+                     (long double)(int64_t)agg_sum_hi :
+                     (long double)agg_sum_hi;
+
+    return (double)((hi * 18446744073709551616.0L + (long double)agg_sum)
+                    / agg_count);
+}
+
+// Get estimation of quantile. Quantile falls into some bucket,
+// its value is interpolated linearly between bucket bounds.
+uint64_t
+aggregate::quantile(double q)
+{
+    bool        sign    = scalar_is_signed(agg_type);
+    uint64_t    key_s   = sign ? KEY_SIGN : 0;
+    long double rank;
+    long double lo;
+    long double hi;
+    long double val;
+    uint64_t    key;
+    uint64_t    acc     = 0;
+    size_t      i;
+
+    if (agg_count == 0)
+        return 0;
+
+    q = q < 0 ? 0 : (q > 1 ? 1 : q);
+    rank = q * (agg_count - 1);
+
+    if (hist_bins > 0)
+    {
+        // Values below histogram bounds
+        if (rank < hist[hist_bins])
+            return min();
+        acc = hist[hist_bins];
+
+        for (i = 0; i < (size_t)hist_bins; i++)
+        {
+            if (rank < acc + hist[i])
+                break;
+            acc += hist[i];
+        }
+        if (i == (size_t)hist_bins)
+            return max();
+
+        lo = hist_lo + i / hist_scale;
+        hi = hist_lo + (i + 1) / hist_scale - 1;
+        val = lo + (hi - lo) * (rank - acc + 0.5) / hist[i];
+        key = (uint64_t)val;
+    }
+    else
+    {
+        for (i = 0; i < hist.size(); i++)
+        {
+            if (rank < acc + hist[i])
+                break;
+            acc += hist[i];
+        }
+        if (i == hist.size())
+            return max();
+
+        if (i == SKETCH_ZERO)
+            return 0;
+
+        if (i > SKETCH_ZERO)
+            sketch_bounds((int)i - SKETCH_ZERO, lo, hi);
+        else
+        {
+            sketch_bounds(SKETCH_ZERO - (int)i, hi, lo);
+            lo = -lo;
+            hi = -hi;
+        }
+        val = lo + (hi - lo) * (rank - acc + 0.5) / hist[i];
+        key = (sign ? (uint64_t)(int64_t)val : (uint64_t)val) ^ key_s;
+    }
+
+    key = key < agg_min ? agg_min : (key > agg_max ? agg_max : key);
+
+    return key ^ key_s;
+}
+
+// Put text report onto output stream
+void
+aggregate::report(ostream &out, base_t base)
+{
+    char        buf[SCALAR_STR_MAX + 1];
+    uint64_t    val;
+    int         n;
+
+#define PUT_VAL(_name, _val)                                    \
+    n = buf_put_int(buf, (_val), agg_type, base);               \
+    buf[n < 0 ? 0 : n] = '\0';                                  \
+    out << _name << buf << endl;
+
+    out << "count:  " << agg_count << endl;
+    out << "errors: " << agg_errs << endl;
+    if (agg_count == 0)
+        return;
+
+    PUT_VAL("min:    ", min())
+    PUT_VAL("max:    ", max())
+    if (sum(val) == 0)
+    {
+        n = buf_put_int(buf, val,
+                        scalar_is_signed(agg_type) ?
+                        scalar_t::TYPE_DOUBLE : scalar_t::TYPE_UDOUBLE,
+                        base);
+        buf[n < 0 ? 0 : n] = '\0';
+        out << "sum:    " << buf << endl;
+    }
+    else
+        out << "sum:    overflow" << endl;
+    out << "mean:   " << mean() << endl;
+
+    for (double q : report_q)
+    {
+        out << "p" << q * 100 << (q * 100 < 10 ? ":     " : ":    ");
+        PUT_VAL("", quantile(q))
+    }
+
+    if (hist_bins > 0)
+    {
+        uint64_t key_s = scalar_is_signed(agg_type) ? KEY_SIGN : 0;
+
+        out << "histogram:" << endl;
+        out << "  below: " << hist[hist_bins] << endl;
+        for (int i = 0; i < hist_bins; i++)
+        {
+            uint64_t lo = hist_lo + (uint64_t)(i / hist_scale);
+
+            n = buf_put_int(buf, lo ^ key_s, agg_type, base);
+            buf[n < 0 ? 0 : n] = '\0';
+            out << "  " << buf << ": " << hist[i] << endl;
+        }
+        out << "  above: " << hist[hist_bins + 1] << endl;
+    }
+#undef PUT_VAL
+}
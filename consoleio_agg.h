@@ -0,0 +1,145 @@
+//////////////////////////////////////////////////////////////
+// Streaming aggregation of integer values:                 //
+// values are parsed from string form and summarized        //
+// (count, min, max, sum, mean, histogram) on the fly       //
+// without building scalar objects.                         //
+//////////////////////////////////////////////////////////////
+#ifndef HAVE_CONSOLEIO_AGG_H
+#define HAVE_CONSOLEIO_AGG_H
+#include "consoleio.h"
+#include <vector>
+
+//////////////////////////////////////////////////////////////
+// Global library defines                                   //
+//////////////////////////////////////////////////////////////
+
+// Number of sub-buckets of quantile sketch per power of two
+// as a power of two. Magnitudes below 2^AGG_SKETCH_BITS
+// get a bucket each, larger ones are split into buckets of
+// width below 1/2^AGG_SKETCH_BITS of their values, so the
+// relative error of sketch quantiles is bounded by
+// 2^-AGG_SKETCH_BITS (3.1% by default).
+#ifndef AGG_SKETCH_BITS
+#define AGG_SKETCH_BITS     5
+#endif
+
+// Number of quantile sketch buckets of each sign: linear
+// buckets of small magnitudes followed by sub-buckets
+// of each bit length
+#define AGG_SKETCH_HALF     ((65 - AGG_SKETCH_BITS) << AGG_SKETCH_BITS)
+
+// Number of buckets of default quantile sketch: negative
+// and positive values share the bucket of zero
+#define AGG_SKETCH_BUCKETS  (2 * AGG_SKETCH_HALF - 1)
+
+//////////////////////////////////////////////////////////////
+// Global library data types                                //
+//////////////////////////////////////////////////////////////
+
+// Class to aggregate integer values of given scalar type
+// taken from text in given enumeration base. Values are
+// counted into a uniform histogram if it is set, otherwise
+// into a log-linear quantile sketch (see AGG_SKETCH_BITS).
+typedef class aggregate
+{
+    private:
+        scalar_t    agg_type;       // Scalar value type
+        base_t      agg_base;       // Enumeration base type
+        uint64_t    agg_count;      // Number of values
+        uint64_t    agg_errs;       // Number of invalid tokens
+        uint64_t    agg_min;        // Minimal and maximal values
+        uint64_t    agg_max;        // as order keys
+        uint64_t    agg_sum;        // Sum in 128-bit raw form,
+        uint64_t    agg_sum_hi;     // low and high words
+        // Histogram bounds as order keys
+        // and number of buckets, 0 - sketch
+        uint64_t    hist_lo;
+        uint64_t    hist_hi;
+        int         hist_bins;
+        double      hist_scale;
+        // Buckets: histogram bins followed by
+        // values below and above the bounds, or
+        // sketch buckets
+        std::vector<uint64_t>   hist;
+        // Incomplete token of the last fed text
+        char        tail[SCALAR_STR_MAX];
+        int         tail_len;
+
+        // Add block of text with complete tokens
+        void        feed_block(const char *buf, size_t len);
+    public:
+        // Constructor
+        //
+        // arg[in] type Scalar value type
+        // arg[in] base Enumeration base type of text
+        aggregate(scalar_t type = SCALAR_DFLT,
+                  base_t base = BASE_DFLT);
+        // Set uniform histogram, all collected
+        // values are dropped.
+        //
+        // arg[in] bins Number of bins, 0 - use sketch
+        // arg[in] lo   Lower bound in raw form
+        // arg[in] hi   Upper bound in raw form
+        //
+        // return 0 on success, -1 on fault
+        int         set_histogram(int bins, uint64_t lo, uint64_t hi);
+        // Drop all collected values
+        void        reset(void);
+        // Add text to aggregation. Text may be split
+        // at any position, incomplete token at the end
+        // is kept until the next call or finish().
+        //
+        // arg[in] buf      Text
+        // arg[in] len      Text length
+        void        feed(const char *buf, size_t len);
+        // The same as feed(), the text is split between
+        // threads with partial aggregates merged then.
+        //
+        // arg[in] threads  Number of threads
+        void        feed_parallel(const char *buf, size_t len,
+                                  int threads);
+        // Add incomplete token kept at the end of text
+        void        finish(void);
+        // Merge partial aggregate collected with the same
+        // type and histogram settings.
+        //
+        // return 0 on success, -1 on fault
+        int         merge(aggregate &part);
+        // Get aggregated values, minimum, maximum and sum
+        // are in raw form.
+        uint64_t
+        count(void)
+        {
+            return agg_count;
+        }
+        uint64_t
+        errors(void)
+        {
+            return agg_errs;
+        }
+        uint64_t    min(void);
+        uint64_t    max(void);
+        // Get sum of values
+        //
+        // return 0 on success, -1 if the sum of all values
+        // does not fit the 64-bit type of the same sign
+        int         sum(uint64_t &val);
+        double      mean(void);
+        // Get estimation of quantile from histogram
+        // or sketch in raw form. Sketch estimations are
+        // within relative error 2^-AGG_SKETCH_BITS.
+        //
+        // arg[in] q    Quantile, 0.0 .. 1.0
+        uint64_t    quantile(double q);
+        // Get histogram buckets, see 'hist'
+        const std::vector<uint64_t>&
+        buckets(void)
+        {
+            return hist;
+        }
+        // Put text report onto output stream,
+        // values are put in given enumeration base.
+        void        report(std::ostream &out, base_t base = BASE_DFLT);
+} aggregate;
+
+#endif //HAVE_CONSOLEIO_AGG_H
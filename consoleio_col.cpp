@@ -0,0 +1,701 @@
+#include "consoleio_col.h"
+#include <cstring>
+#include <fcntl.h>
+#ifdef _WIN32
+#include <io.h>
+#include <intrin.h>
+#else
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+//////////////////////////////////////////////////////
+// Module global namespace                          //
+//////////////////////////////////////////////////////
+using namespace std;
+
+//////////////////////////////////////////////////////
+// Module global macros                             //
+//////////////////////////////////////////////////////
+// Format version
+#define COL_VERSION     2
+
+// Byte order mark of file written in the other byte order
+#define COL_BOM_SWAP    ((COL_BOM >> 8 | COL_BOM << 8) & 0xffff)
+
+// Maximal length of variable length integer
+#define VARINT_MAX      10
+
+// Size of text chunk written onto output stream at once
+#define TEXT_SIZE       (1 << 16)
+
+// File structures are written as is
+static_assert(sizeof(col_header) == 16, "col_header must be 16 bytes");
+static_assert(sizeof(col_block) == 56, "col_block must be 56 bytes");
+static_assert(sizeof(col_trailer) == 32, "col_trailer must be 32 bytes");
+
+//////////////////////////////////////////////////////
+// Module global functions                          //
+//////////////////////////////////////////////////////
+
+// Get mask of given number of low bits
+static inline uint64_t
+bits_mask(int bits)
+{
+    return bits >= 64 ? ~(uint64_t)0 : ((uint64_t)1 << bits) - 1;
+}
+
+// Get number of significant bits of value
+static inline int
+bit_len(uint64_t val)
+{
+#ifdef _MSC_VER
+    unsigned long idx;
+
+    return _BitScanReverse64(&idx, val) ? (int)idx + 1 : 0;
+#else
+    return val == 0 ? 0 : 64 - __builtin_clzll(val);
+#endif
+}
+
+// Encode signed difference so that small absolute
+// values get small codes
+static inline uint64_t
+zigzag(uint64_t diff)
+{
+    return (diff << 1) ^ (uint64_t)((int64_t)diff >> 63);
+}
+
+// Decode zigzag code
+static inline uint64_t
+unzigzag(uint64_t code)
+{
+    return (code >> 1) ^ (0 - (code & 1));
+}
+
+// Get packed value at bit position, read with one
+// 8-byte load and one extra byte (see COL_BLOCK_PAD)
+static inline uint64_t
+unpack(const uint8_t *data, uint64_t pos, int width)
+{
+    const uint8_t  *p       = data + (pos >> 3);
+    int             shift   = (int)(pos & 7);
+    uint64_t        val;
+
+    memcpy(&val, p, 8);
+    val >>= shift;
+    if (shift + width > 64)
+        val |= (uint64_t)p[8] << (64 - shift);
+
+    return val & bits_mask(width);
+}
+
+//////////////////////////////////////////////////////
+// Class 'col_writer' methods,                      //
+// see definition in consoleio_col.h                //
+//////////////////////////////////////////////////////
+
+// Constructor
+col_writer::col_writer(scalar_t type) : col_type(type)
+{
+    file = nullptr;
+    file_off = 0;
+    n_vals = 0;
+}
+
+// Destructor, unfinished file gets its index
+col_writer::~col_writer()
+{
+    if (file != nullptr)
+        close();
+}
+
+// Write data onto output stream
+int
+col_writer::write(const void *buf, size_t len)
+{
+    if (len != 0 && fwrite(buf, 1, len, file) != len)
+    {
+        cerr << "col_writer.write(): Failed to write file." << endl;
+        return -1;
+    }
+
+    file_off += len;
+
+    return 0;
+}
+
+// Start writing file onto output stream
+int
+col_writer::open(FILE *out)
+{
+    col_header hdr;
+
+    if (scalar_bits(col_type) < 0 || out == nullptr)
+    {
+        cerr << "col_writer.open(): Value type or stream is invalid."
+             << endl;
+        return -1;
+    }
+
+    file = out;
+    file_off = 0;
+    n_vals = 0;
+    vals.clear();
+    vals.reserve(COL_BLOCK_VALS);
+    index.clear();
+
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, COL_MAGIC, COL_MAGIC_LEN);
+    hdr.version = COL_VERSION;
+    hdr.type = (uint8_t)col_type;
+    hdr.bom = COL_BOM;
+
+    return write(&hdr, sizeof(hdr));
+}
+
+// Add integer values
+int
+col_writer::put(const uint64_t *raw, size_t n)
+{
+    if (file == nullptr)
+    {
+        cerr << "col_writer.put(): File is not open." << endl;
+        return -1;
+    }
+
+    for (size_t i = 0; i < n; i++)
+    {
+        vals.push_back(raw_cast(raw[i], col_type));
+        if (vals.size() == COL_BLOCK_VALS && flush() != 0)
+            return -1;
+    }
+
+    return 0;
+}
+
+// Encode and write current block. Values are turned into
+// order keys, differences of neighbour keys are zigzag
+// encoded and either packed with the width of the widest
+// code or put as variable length integers, whichever is
+// shorter.
+int
+col_writer::flush(void)
+{
+    int         bits    = scalar_bits(col_type);
+    uint64_t    mask    = bits_mask(bits);
+    uint64_t    flip    = scalar_is_signed(col_type) ?
+                          (uint64_t)1 << (bits - 1) : 0;
+    size_t      n       = vals.size();
+    col_block   blk;
+    uint64_t    kmin;
+    uint64_t    kmax;
+    uint64_t    prev;
+    int         width   = 0;
+    size_t      varint  = 0;
+    size_t      packed;
+
+    if (n == 0)
+        return 0;
+
+    memset(&blk, 0, sizeof(blk));
+    kmin = kmax = prev = (vals[0] & mask) ^ flip;
+
+    // Replace values by delta codes in place
+    for (size_t i = 1; i < n; i++)
+    {
+        uint64_t    key     = (vals[i] & mask) ^ flip;
+        uint64_t    code    = zigzag(key - prev);
+        int         len     = bit_len(code);
+
+        kmin = key < kmin ? key : kmin;
+        kmax = key > kmax ? key : kmax;
+        prev = key;
+
+        vals[i] = code;
+        width = len > width ? len : width;
+        varint += len == 0 ? 1 : (len + 6) / 7;
+    }
+
+    packed = ((n - 1) * width + 7) / 8;
+
+    data.clear();
+    if (packed <= varint)
+    {
+        uint64_t    acc     = 0;
+        int         acc_len = 0;
+
+        blk.enc = (uint8_t)col_enc_t::COL_ENC_PACK;
+        blk.width = (uint8_t)width;
+
+        for (size_t i = 1; i < n && width > 0; i++)
+        {
+            uint64_t code = vals[i];
+
+            acc |= code << acc_len;
+            if (acc_len + width >= 64)
+            {
+                uint8_t b[8];
+
+                memcpy(b, &acc, 8);
+                data.insert(data.end(), b, b + 8);
+                acc = acc_len != 0 ? code >> (64 - acc_len) : 0;
+                acc_len += width - 64;
+            }
+            else
+                acc_len += width;
+        }
+
+        for (; acc_len > 0; acc_len -= 8, acc >>= 8)
+            data.push_back((uint8_t)acc);
+    }
+    else
+    {
+        blk.enc = (uint8_t)col_enc_t::COL_ENC_VARINT;
+
+        for (size_t i = 1; i < n; i++)
+        {
+            uint64_t code = vals[i];
+
+            while (code >= 0x80)
+            {
+                data.push_back((uint8_t)(code | 0x80));
+                code >>= 7;
+            }
+            data.push_back((uint8_t)code);
+        }
+    }
+    data.insert(data.end(), COL_BLOCK_PAD, 0);
+
+    blk.offset = file_off;
+    blk.first = n_vals;
+    blk.count = (uint32_t)n;
+    blk.size = (uint32_t)data.size();
+    blk.base = vals[0];
+    blk.min = raw_cast(kmin ^ flip, col_type);
+    blk.max = raw_cast(kmax ^ flip, col_type);
+
+    if (write(data.data(), data.size()) != 0)
+        return -1;
+
+    index.push_back(blk);
+    n_vals += n;
+    vals.clear();
+
+    return 0;
+}
+
+// Write the last block and the index,
+// the index is aligned to 8 bytes.
+int
+col_writer::close(void)
+{
+    static const uint8_t    zero[8] = {0,};
+    col_trailer             trl;
+    int                     rc;
+
+    if (file == nullptr)
+        return -1;
+
+    rc = flush();
+    if (rc == 0)
+        rc = write(zero, (8 - file_off % 8) % 8);
+
+    memset(&trl, 0, sizeof(trl));
+    trl.index = file_off;
+    trl.n_blocks = index.size();
+    trl.n_vals = n_vals;
+    memcpy(trl.magic, COL_MAGIC_IDX, COL_MAGIC_LEN);
+
+    if (rc == 0)
+        rc = write(index.data(), index.size() * sizeof(col_block));
+    if (rc == 0)
+        rc = write(&trl, sizeof(trl));
+
+    file = nullptr;
+
+    return rc;
+}
+
+//////////////////////////////////////////////////////
+// Class 'col_reader' methods,                      //
+// see definition in consoleio_col.h                //
+//////////////////////////////////////////////////////
+
+// Constructor
+col_reader::col_reader()
+{
+    map = nullptr;
+    map_len = 0;
+    map_own = false;
+    col_type = scalar_t::TYPE_INVAL;
+    index = nullptr;
+    n_blocks = 0;
+    n_vals = 0;
+    cache_blk = -1;
+}
+
+// Destructor
+col_reader::~col_reader()
+{
+    close();
+}
+
+// Open columnar file. Regular files are mapped into
+// memory, the rest is read into allocated memory.
+int
+col_reader::open(const char *path)
+{
+    col_header      hdr;
+    col_trailer     trl;
+    uint64_t        total   = 0;
+    int             fd;
+
+    close();
+
+#ifdef _WIN32
+    fd = ::open(path, O_RDONLY | O_BINARY);
+#else
+    fd = ::open(path, O_RDONLY);
+#endif
+    if (fd < 0)
+    {
+        cerr << "col_reader.open(): Failed to open file '" << path << "'."
+             << endl;
+        return -1;
+    }
+
+#ifndef _WIN32
+    {
+        struct stat st;
+
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+        {
+            void *p = mmap(nullptr, (size_t)st.st_size, PROT_READ,
+                           MAP_PRIVATE, fd, 0);
+
+            if (p != MAP_FAILED)
+            {
+                map = (const uint8_t *)p;
+                map_len = (size_t)st.st_size;
+            }
+        }
+    }
+#endif
+
+    if (map == nullptr)
+    {
+        vector<uint8_t> buf;
+        uint8_t         chunk[1 << 16];
+        long            n;
+
+        while ((n = (long)read(fd, chunk, sizeof(chunk))) > 0)
+            buf.insert(buf.end(), chunk, chunk + n);
+
+        map_len = buf.size();
+        map = new uint8_t[map_len + 1];
+        memcpy((uint8_t *)map, buf.data(), map_len);
+        map_own = true;
+    }
+    ::close(fd);
+
+    if (map_len < sizeof(hdr) + sizeof(trl))
+    {
+        cerr << "col_reader.open(): File '" << path << "' is too short."
+             << endl;
+        close();
+        return -1;
+    }
+
+    memcpy(&hdr, map, sizeof(hdr));
+    memcpy(&trl, map + map_len - sizeof(trl), sizeof(trl));
+
+    if (memcmp(hdr.magic, COL_MAGIC, COL_MAGIC_LEN) == 0 &&
+        hdr.bom == COL_BOM_SWAP)
+    {
+        cerr << "col_reader.open(): File '" << path
+             << "' is written in other byte order." << endl;
+        close();
+        return -1;
+    }
+
+    if (memcmp(hdr.magic, COL_MAGIC, COL_MAGIC_LEN) != 0 ||
+        memcmp(trl.magic, COL_MAGIC_IDX, COL_MAGIC_LEN) != 0 ||
+        hdr.version != COL_VERSION ||
+        scalar_bits((scalar_t)hdr.type) < 0 ||
+        trl.index % 8 != 0 || trl.index > map_len - sizeof(trl) ||
+        trl.n_blocks > (map_len - sizeof(trl) - trl.index) /
+                       sizeof(col_block))
+    {
+        cerr << "col_reader.open(): File '" << path
+             << "' is not a valid columnar file." << endl;
+        close();
+        return -1;
+    }
+
+    col_type = (scalar_t)hdr.type;
+    index = (const col_block *)(map + trl.index);
+    n_blocks = (size_t)trl.n_blocks;
+    n_vals = trl.n_vals;
+
+    // Blocks must follow each other by value numbers,
+    // get() relies on it to address decoded values
+    for (size_t i = 0; i < n_blocks; i++)
+    {
+        const col_block &blk = index[i];
+
+        if (blk.first != total ||
+            blk.offset < sizeof(hdr) || blk.offset > trl.index ||
+            blk.size > trl.index - blk.offset ||
+            blk.size < COL_BLOCK_PAD || blk.count == 0 ||
+            blk.count > COL_BLOCK_VALS || blk.width > 64 ||
+            blk.enc >= (uint8_t)col_enc_t::COL_ENC_INVAL ||
+            (blk.enc == (uint8_t)col_enc_t::COL_ENC_PACK &&
+             ((uint64_t)(blk.count - 1) * blk.width + 7) / 8 >
+             blk.size - COL_BLOCK_PAD))
+        {
+            cerr << "col_reader.open(): Block " << i << " of file '"
+                 << path << "' is invalid." << endl;
+            close();
+            return -1;
+        }
+
+        total += blk.count;
+    }
+
+    if (total != n_vals)
+    {
+        cerr << "col_reader.open(): Number of values of file '" << path
+             << "' is invalid." << endl;
+        close();
+        return -1;
+    }
+
+    cache.resize(COL_BLOCK_VALS);
+
+    return 0;
+}
+
+// Close file
+void
+col_reader::close(void)
+{
+    if (map != nullptr)
+    {
+#ifndef _WIN32
+        if (!map_own)
+            munmap((void *)map, map_len);
+#endif
+        if (map_own)
+            delete[] map;
+    }
+
+    map = nullptr;
+    map_len = 0;
+    map_own = false;
+    index = nullptr;
+    n_blocks = 0;
+    n_vals = 0;
+    cache_blk = -1;
+}
+
+// Check whether block may hold values in range
+bool
+col_reader::block_overlaps(size_t blk, uint64_t lo, uint64_t hi)
+{
+    int         bits    = scalar_bits(col_type);
+    uint64_t    mask    = bits_mask(bits);
+    uint64_t    flip    = scalar_is_signed(col_type) ?
+                          (uint64_t)1 << (bits - 1) : 0;
+
+    if (blk >= n_blocks)
+        return false;
+
+    return ((index[blk].min & mask) ^ flip) <= ((hi & mask) ^ flip) &&
+           ((index[blk].max & mask) ^ flip) >= ((lo & mask) ^ flip);
+}
+
+// Decode block of values
+int
+col_reader::decode(size_t blk, uint64_t *vals)
+{
+    int             bits    = scalar_bits(col_type);
+    uint64_t        mask    = bits_mask(bits);
+    uint64_t        flip    = scalar_is_signed(col_type) ?
+                              (uint64_t)1 << (bits - 1) : 0;
+    const col_block *b;
+    const uint8_t  *data;
+    const uint8_t  *end;
+    uint64_t        key;
+
+    if (blk >= n_blocks)
+    {
+        cerr << "col_reader.decode(): Block number is invalid." << endl;
+        return -1;
+    }
+
+    b = &index[blk];
+    data = map + b->offset;
+    end = data + b->size - COL_BLOCK_PAD;
+    key = (b->base & mask) ^ flip;
+    vals[0] = raw_cast(b->base, col_type);
+
+    if (b->enc == (uint8_t)col_enc_t::COL_ENC_PACK)
+    {
+        int         width   = b->width;
+        uint64_t    pos     = 0;
+
+        for (uint32_t i = 1; i < b->count; i++, pos += width)
+        {
+            key = (key + unzigzag(unpack(data, pos, width))) & mask;
+            vals[i] = raw_cast(key ^ flip, col_type);
+        }
+
+        return 0;
+    }
+
+    for (uint32_t i = 1; i < b->count; i++)
+    {
+        uint64_t    code    = 0;
+        int         shift   = 0;
+        uint8_t     byte;
+
+        do
+        {
+            if (data == end || shift >= VARINT_MAX * 7)
+            {
+                cerr << "col_reader.decode(): Block data is invalid."
+                     << endl;
+                return -1;
+            }
+            byte = *data++;
+            code |= (uint64_t)(byte & 0x7f) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+
+        key = (key + unzigzag(code)) & mask;
+        vals[i] = raw_cast(key ^ flip, col_type);
+    }
+
+    return 0;
+}
+
+// Get value by number
+int
+col_reader::get(uint64_t n, uint64_t &val)
+{
+    size_t lo = 0;
+    size_t hi = n_blocks;
+
+    if (n >= n_vals)
+    {
+        cerr << "col_reader.get(): Value number is out of range." << endl;
+        return -1;
+    }
+
+    // Find the last block starting at or before the value
+    while (hi - lo > 1)
+    {
+        size_t mid = (lo + hi) / 2;
+
+        if (index[mid].first <= n)
+            lo = mid;
+        else
+            hi = mid;
+    }
+
+    if (cache_blk != (long long)lo)
+    {
+        if (decode(lo, cache.data()) != 0)
+        {
+            cache_blk = -1;
+            return -1;
+        }
+        cache_blk = (long long)lo;
+    }
+
+    val = cache[n - index[lo].first];
+
+    return 0;
+}
+
+// Get values in range
+int
+col_reader::find(uint64_t lo, uint64_t hi, vector<uint64_t> &vals)
+{
+    int         bits    = scalar_bits(col_type);
+    uint64_t    mask    = bits_mask(bits);
+    uint64_t    flip    = scalar_is_signed(col_type) ?
+                          (uint64_t)1 << (bits - 1) : 0;
+    uint64_t    klo     = (lo & mask) ^ flip;
+    uint64_t    khi     = (hi & mask) ^ flip;
+
+    for (size_t blk = 0; blk < n_blocks; blk++)
+    {
+        if (!block_overlaps(blk, lo, hi))
+            continue;
+
+        if (decode(blk, cache.data()) != 0)
+        {
+            cache_blk = -1;
+            return -1;
+        }
+        cache_blk = (long long)blk;
+
+        for (uint32_t i = 0; i < index[blk].count; i++)
+        {
+            uint64_t key = (cache[i] & mask) ^ flip;
+
+            if (key >= klo && key <= khi)
+                vals.push_back(cache[i]);
+        }
+    }
+
+    return 0;
+}
+
+// Put all values onto output stream in string form
+int
+col_reader::put_text(ostream &out, scalar_t type, base_t base,
+                     group grp, char sep)
+{
+    vector<char>    text(TEXT_SIZE + SCALAR_STR_MAX + 1);
+    size_t          pos     = 0;
+
+    if (type == scalar_t::TYPE_INVAL)
+        type = col_type;
+
+    if (scalar_bits(type) < 0 || (int)base >= (int)base_t::BASE_INVAL)
+    {
+        cerr << "col_reader.put_text(): Value type or base is invalid."
+             << endl;
+        return -1;
+    }
+
+    for (size_t blk = 0; blk < n_blocks; blk++)
+    {
+        if (decode(blk, cache.data()) != 0)
+        {
+            cache_blk = -1;
+            return -1;
+        }
+        cache_blk = (long long)blk;
+
+        for (uint32_t i = 0; i < index[blk].count; i++)
+        {
+            pos += buf_put_int(text.data() + pos, raw_cast(cache[i], type),
+                               type, base, grp);
+            text[pos++] = sep;
+
+            if (pos >= TEXT_SIZE)
+            {
+                out.write(text.data(), pos);
+                pos = 0;
+            }
+        }
+    }
+    out.write(text.data(), pos);
+
+    return out.good() ? 0 : -1;
+}
@@ -0,0 +1,240 @@
+//////////////////////////////////////////////////////////////
+// Columnar file format of integer values:                  //
+// values of one scalar type are stored by blocks of        //
+// delta encoded values, footer index of blocks allows      //
+// seeking to value number and skipping blocks by value     //
+// range. Files are read through memory mapping.            //
+//////////////////////////////////////////////////////////////
+#ifndef HAVE_CONSOLEIO_COL_H
+#define HAVE_CONSOLEIO_COL_H
+#include "consoleio.h"
+#include <cstdio>
+#include <vector>
+
+//////////////////////////////////////////////////////////////
+// Global library defines                                   //
+//////////////////////////////////////////////////////////////
+
+// Magic strings of file header and trailer
+#define COL_MAGIC       "CIOCOL01"
+#define COL_MAGIC_IDX   "CIOCOLIX"
+#define COL_MAGIC_LEN   8
+
+// Number of values in block, the last block may be shorter
+#define COL_BLOCK_VALS  4096
+
+// Byte order mark of file header, stored in byte
+// order of the writing host
+#define COL_BOM         0x0102
+
+// Zero bytes after each block of data, so packed
+// values are read with fixed size loads
+#define COL_BLOCK_PAD   8
+
+//////////////////////////////////////////////////////////////
+// Global library data types                                //
+//////////////////////////////////////////////////////////////
+
+// Encoding of block of values
+enum class col_enc_t : uint8_t
+{
+    COL_ENC_PACK = 0,   // Deltas packed with fixed bit width
+    COL_ENC_VARINT,     // Deltas as variable length integers
+    COL_ENC_INVAL,
+};
+
+// File layout (fields and packed deltas are in byte order of
+// the writing host, files of the other order are rejected by
+// COL_BOM of header):
+//
+//  col_header
+//  block data ...
+//  col_block index[n_blocks]
+//  col_trailer
+//
+// Each block keeps its first value in the index, the
+// following values are differences of neighbour values
+// taken as order keys (see radix_sort()) and zigzag encoded.
+
+// File header
+struct col_header
+{
+    char        magic[COL_MAGIC_LEN];   // COL_MAGIC
+    uint32_t    version;                // Format version, 2
+    uint8_t     type;                   // Scalar value type
+    uint8_t     pad;
+    uint16_t    bom;                    // COL_BOM
+};
+
+// Index entry of block
+struct col_block
+{
+    uint64_t    offset;     // Block data offset in file
+    uint64_t    first;      // Number of the first value
+    uint64_t    min;        // Minimal and maximal values
+    uint64_t    max;        // in raw form
+    uint64_t    base;       // The first value in raw form
+    uint32_t    count;      // Number of values
+    uint32_t    size;       // Block data size with padding
+    uint8_t     enc;        // Encoding, see col_enc_t
+    uint8_t     width;      // Bit width of packed deltas
+    uint8_t     pad[6];
+};
+
+// File trailer
+struct col_trailer
+{
+    uint64_t    index;      // Index offset in file
+    uint64_t    n_blocks;   // Number of blocks
+    uint64_t    n_vals;     // Number of values
+    char        magic[COL_MAGIC_LEN];   // COL_MAGIC_IDX
+};
+
+// Class to write integer values in raw form into columnar
+// file. Values are collected into block which is encoded
+// and written when it is full, the index is written by
+// close(). Output is written sequentially, so any C stream
+// (including pipes) may be used.
+typedef class col_writer
+{
+    private:
+        scalar_t                col_type;   // Scalar value type
+        FILE                   *file;       // Output stream
+        uint64_t                file_off;   // Output offset
+        uint64_t                n_vals;     // Number of values
+        std::vector<uint64_t>   vals;       // Values of current block
+        std::vector<uint8_t>    data;       // Encoded block
+        std::vector<col_block>  index;      // Written blocks
+
+        // Write data onto output stream
+        int         write(const void *buf, size_t len);
+        // Encode and write current block
+        int         flush(void);
+    public:
+        // Constructor
+        //
+        // arg[in] type Scalar value type
+        col_writer(scalar_t type = SCALAR_DFLT);
+        ~col_writer();
+        // Start writing file onto output stream
+        //
+        // arg[in] out  Output stream, kept open by close()
+        //
+        // return 0 on success, -1 on fault
+        int         open(FILE *out);
+        // Add integer values, values are cast
+        // to scalar type (see raw_cast()).
+        //
+        // arg[in] raw  Raw integer values
+        // arg[in] n    Number of values
+        //
+        // return 0 on success, -1 on fault
+        int         put(const uint64_t *raw, size_t n);
+        // Write the last block and the index
+        //
+        // return 0 on success, -1 on fault
+        int         close(void);
+} col_writer;
+
+// Class to read columnar file. The file is mapped into
+// memory, index and block data are used in place, only
+// decoded values are copied.
+typedef class col_reader
+{
+    private:
+        const uint8_t          *map;        // File contents
+        size_t                  map_len;
+        bool                    map_own;    // Contents are allocated
+        scalar_t                col_type;   // Scalar value type
+        const col_block        *index;      // Index of blocks
+        size_t                  n_blocks;
+        uint64_t                n_vals;
+        // The last decoded block
+        std::vector<uint64_t>   cache;
+        long long               cache_blk;
+    public:
+        // Constructor
+        col_reader();
+        ~col_reader();
+        col_reader(const col_reader &) = delete;
+        col_reader &operator=(const col_reader &) = delete;
+        // Open columnar file
+        //
+        // arg[in] path File path
+        //
+        // return 0 on success, -1 on fault
+        int         open(const char *path);
+        // Close file
+        void        close(void);
+        // Get scalar value type of file values
+        scalar_t
+        type(void)
+        {
+            return col_type;
+        }
+        // Get number of values
+        uint64_t
+        count(void)
+        {
+            return n_vals;
+        }
+        // Get number of blocks
+        size_t
+        blocks(void)
+        {
+            return n_blocks;
+        }
+        // Get index entry of block
+        const col_block&
+        block(size_t blk)
+        {
+            return index[blk];
+        }
+        // Check whether block may hold values in range
+        //
+        // arg[in] blk  Block number
+        // arg[in] lo   Lower bound in raw form
+        // arg[in] hi   Upper bound in raw form
+        bool        block_overlaps(size_t blk, uint64_t lo, uint64_t hi);
+        // Decode block of values
+        //
+        // arg[in]  blk     Block number
+        // arg[out] vals    Raw integer values, room for
+        //                  block(blk).count values
+        //
+        // return 0 on success, -1 on fault
+        int         decode(size_t blk, uint64_t *vals);
+        // Get value by number, its block is decoded
+        // and kept until another block is accessed.
+        //
+        // arg[in]  n   Value number
+        // arg[out] val Raw integer value
+        //
+        // return 0 on success, -1 on fault
+        int         get(uint64_t n, uint64_t &val);
+        // Get values in range, blocks out of range
+        // are skipped without decoding.
+        //
+        // arg[in]  lo      Lower bound in raw form
+        // arg[in]  hi      Upper bound in raw form
+        // arg[out] vals    Raw integer values in file order
+        //
+        // return 0 on success, -1 on fault
+        int         find(uint64_t lo, uint64_t hi,
+                         std::vector<uint64_t> &vals);
+        // Put all values onto output stream in string form,
+        // values are cast to given type (see raw_cast()).
+        //
+        // arg[in] out  Output stream
+        // arg[in] type Scalar value type, scalar_t::TYPE_INVAL
+        //              for the type of file values
+        // arg[in] base Enumeration base type
+        // arg[in] grp  Digit grouping
+        // arg[in] sep  Separator put after each value
+        //
+        // return 0 on success, -1 on fault
+        int         put_text(std::ostream &out, scalar_t type, base_t base,
+                             group grp = GROUP_NONE, char sep = '\n');
+} col_reader;
+
+#endif //HAVE_CONSOLEIO_COL_H
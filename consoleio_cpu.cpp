@@ -0,0 +1,416 @@
+#include "consoleio_cpu.h"
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+// Vector kernels are compiled with target attributes,
+// so the rest of the library keeps baseline instructions.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CPU_DISPATCH_X86
+#include <immintrin.h>
+#endif
+
+//////////////////////////////////////////////////////
+// Module global namespace                          //
+//////////////////////////////////////////////////////
+using namespace std;
+
+//////////////////////////////////////////////////////
+// Module global macros                             //
+//////////////////////////////////////////////////////
+// Target attributes of kernel variants
+#define TARGET_SSE      __attribute__((target("sse4.2")))
+#define TARGET_AVX2     __attribute__((target("avx2,bmi2")))
+#define TARGET_AVX512   __attribute__((target("avx512f,avx512bw,bmi2")))
+
+//////////////////////////////////////////////////////
+// Module global objects                            //
+//////////////////////////////////////////////////////
+// Instruction set name
+static const char*
+isa_name_s[] = {ISA_SCALAR_S, ISA_SSE_S, ISA_AVX2_S, ISA_AVX512_S};
+
+// Dispatch tables of each instruction set,
+// scalar table has no kernels
+static cpu_dispatch     cpu_tabs[(int)isa_t::ISA_INVAL];
+
+// Selected dispatch table, none until the first use
+std::atomic<const cpu_dispatch *>   cpu_tab(nullptr);
+
+// Kernels are selected once
+static once_flag        cpu_once;
+
+#ifdef CPU_DISPATCH_X86
+//////////////////////////////////////////////////////
+// Module global functions                          //
+//////////////////////////////////////////////////////
+
+// Namespace for SSE kernels
+namespace sse_io {
+// Put integer value in hexadecimal format: nibbles of
+// value bytes are interleaved and turned into digits
+// by a single byte shuffle.
+//
+// W - printable width in characters
+template <int W>
+TARGET_SSE static int
+put_hex(char *buf, uint64_t val)
+{
+    uint64_t    x       = __builtin_bswap64(val << (64 - W * 4));
+    __m128i     lo_mask = _mm_set1_epi8(0x0f);
+    __m128i     bytes   = _mm_loadl_epi64((const __m128i *)&x);
+    __m128i     hi      = _mm_and_si128(_mm_srli_epi16(bytes, 4), lo_mask);
+    __m128i     lo      = _mm_and_si128(bytes, lo_mask);
+    __m128i     digits  = _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6',
+                                        '7', '8', '9', 'a', 'b', 'c', 'd',
+                                        'e', 'f');
+
+    digits = _mm_shuffle_epi8(digits, _mm_unpacklo_epi8(hi, lo));
+    _mm_storeu_si128((__m128i *)buf, digits);
+
+    return W;
+}
+
+// Put integer value in binary format by 16 digits:
+// value bytes are broadcast, each output byte tests
+// its own bit.
+//
+// BITS - size of integer value in bits
+template <int BITS>
+TARGET_SSE static int
+put_bin(char *buf, uint64_t val)
+{
+    uint64_t    x       = val << (64 - BITS);
+    __m128i     bit     = _mm_set1_epi64x(0x0102040810204080LL);
+    __m128i     order   = _mm_setr_epi8(1, 1, 1, 1, 1, 1, 1, 1,
+                                        0, 0, 0, 0, 0, 0, 0, 0);
+    __m128i     zero    = _mm_set1_epi8('0');
+
+    for (int i = 0; i < BITS; i += 16)
+    {
+        __m128i v = _mm_set1_epi16((short)(x >> (48 - i)));
+
+        v = _mm_shuffle_epi8(v, order);
+        v = _mm_cmpeq_epi8(_mm_and_si128(v, bit), bit);
+        _mm_storeu_si128((__m128i *)(buf + i), _mm_sub_epi8(zero, v));
+    }
+
+    return BITS;
+}
+
+// Get integer value of 8 or 16 hexadecimal digits:
+// characters are validated and turned into nibbles by
+// byte compares, nibble pairs are joined by multiply-add.
+// Other strings are left to generic parser.
+//
+// BITS - size of integer value in bits, 32 or 64
+// SIGN - whether value is of signed type
+template <int BITS, bool SIGN>
+TARGET_SSE static int
+get_hex(const char *str, size_t len, uint64_t &val)
+{
+    __m128i     v;
+    __m128i     lower;
+    __m128i     digit;
+    __m128i     alpha;
+    __m128i     nib;
+    uint64_t    x;
+    int         full;
+
+    if (len == 16 && BITS == 64)
+    {
+        v = _mm_loadu_si128((const __m128i *)str);
+        full = 0xffff;
+    }
+    else if (len == 8)
+    {
+        v = _mm_loadl_epi64((const __m128i *)str);
+        full = 0xff;
+    }
+    else
+        return -1;
+
+    lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+                          _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+    alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                          _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+    if ((_mm_movemask_epi8(_mm_or_si128(digit, alpha)) & full) != full)
+        return -1;
+
+    nib = _mm_or_si128(
+        _mm_and_si128(_mm_sub_epi8(v, _mm_set1_epi8('0')), digit),
+        _mm_and_si128(_mm_sub_epi8(lower, _mm_set1_epi8('a' - 10)), alpha));
+    nib = _mm_maddubs_epi16(nib, _mm_set1_epi16(0x0110));
+    nib = _mm_packus_epi16(nib, nib);
+    _mm_storel_epi64((__m128i *)&x, nib);
+
+    x = __builtin_bswap64(x);
+    if (len == 8)
+        x >>= 32;
+    if (BITS == 32 && SIGN)
+        x = (uint64_t)(int64_t)(int32_t)x;
+    val = x;
+
+    return 0;
+}
+} // namespace sse_io
+
+// Namespace for AVX2 kernels
+namespace avx2_io {
+// Put integer value in binary format by 32 digits
+//
+// BITS - size of integer value in bits
+template <int BITS>
+TARGET_AVX2 static int
+put_bin(char *buf, uint64_t val)
+{
+    uint64_t    x       = val << (64 - BITS);
+    __m256i     bit     = _mm256_set1_epi64x(0x0102040810204080LL);
+    __m256i     order   = _mm256_setr_epi8(3, 3, 3, 3, 3, 3, 3, 3,
+                                           2, 2, 2, 2, 2, 2, 2, 2,
+                                           1, 1, 1, 1, 1, 1, 1, 1,
+                                           0, 0, 0, 0, 0, 0, 0, 0);
+    __m256i     zero    = _mm256_set1_epi8('0');
+
+    for (int i = 0; i < BITS; i += 32)
+    {
+        __m256i v = _mm256_set1_epi32((int)(x >> (32 - i)));
+
+        v = _mm256_shuffle_epi8(v, order);
+        v = _mm256_cmpeq_epi8(_mm256_and_si256(v, bit), bit);
+        _mm256_storeu_si256((__m256i *)(buf + i), _mm256_sub_epi8(zero, v));
+    }
+
+    return BITS;
+}
+} // namespace avx2_io
+
+// Namespace for AVX-512 kernels
+namespace avx512_io {
+// Put integer value in binary format: bits are reversed
+// into output order and turned into digits by a single
+// masked blend, exactly BITS characters are stored.
+//
+// BITS - size of integer value in bits
+template <int BITS>
+TARGET_AVX512 static int
+put_bin(char *buf, uint64_t val)
+{
+    uint64_t    x       = __builtin_bswap64(val << (64 - BITS));
+    __m512i     digits;
+
+    x = ((x >> 1) & 0x5555555555555555ULL) | ((x & 0x5555555555555555ULL) << 1);
+    x = ((x >> 2) & 0x3333333333333333ULL) | ((x & 0x3333333333333333ULL) << 2);
+    x = ((x >> 4) & 0x0f0f0f0f0f0f0f0fULL) | ((x & 0x0f0f0f0f0f0f0f0fULL) << 4);
+
+    digits = _mm512_mask_blend_epi8(x, _mm512_set1_epi8('0'),
+                                    _mm512_set1_epi8('1'));
+    _mm512_mask_storeu_epi8(buf, ~0ULL >> (64 - BITS), digits);
+
+    return BITS;
+}
+} // namespace avx512_io
+
+// Convert byte order of values by blocks of 16 bytes,
+// a single byte shuffle reverses bytes of each value.
+// SSSE3 shuffle is available on CPUs of all vector
+// kernel variants.
+TARGET_SSE static size_t
+sse_swap(void *dst, const void *src, size_t bytes, int size)
+{
+    const uint8_t  *s       = (const uint8_t *)src;
+    uint8_t        *d       = (uint8_t *)dst;
+    size_t          i       = 0;
+    __m128i         mask;
+
+    if (size == 2)
+        mask = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6,
+                             9, 8, 11, 10, 13, 12, 15, 14);
+    else if (size == 4)
+        mask = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4,
+                             11, 10, 9, 8, 15, 14, 13, 12);
+    else if (size == 8)
+        mask = _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0,
+                             15, 14, 13, 12, 11, 10, 9, 8);
+    else
+        return 0;
+
+    for (; i + 16 <= bytes; i += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(s + i));
+
+        _mm_storeu_si128((__m128i *)(d + i), _mm_shuffle_epi8(v, mask));
+    }
+
+    return i;
+}
+
+// Kernels of each value size: 8, 16, 32 and 64 bits
+static const cpu_put_fn sse_hex[]    = {sse_io::put_hex<2>,
+                                        sse_io::put_hex<4>,
+                                        sse_io::put_hex<8>,
+                                        sse_io::put_hex<16>};
+static const cpu_put_fn sse_bin[]    = {sse_io::put_bin<8>,
+                                        sse_io::put_bin<16>,
+                                        sse_io::put_bin<32>,
+                                        sse_io::put_bin<64>};
+static const cpu_put_fn avx2_bin[]   = {avx2_io::put_bin<8>,
+                                        avx2_io::put_bin<16>,
+                                        avx2_io::put_bin<32>,
+                                        avx2_io::put_bin<64>};
+static const cpu_put_fn avx512_bin[] = {avx512_io::put_bin<8>,
+                                        avx512_io::put_bin<16>,
+                                        avx512_io::put_bin<32>,
+                                        avx512_io::put_bin<64>};
+
+// Kernels of each scalar type
+static const cpu_get_fn sse_get_hex[] = {nullptr, nullptr,
+                                         nullptr, nullptr,
+                                         sse_io::get_hex<32, true>,
+                                         sse_io::get_hex<32, false>,
+                                         sse_io::get_hex<64, true>,
+                                         sse_io::get_hex<64, false>};
+
+// Fill dispatch table of instruction set
+//
+// arg[out] tab Dispatch table
+// arg[in]  isa Instruction set
+static void
+cpu_fill(cpu_dispatch &tab, isa_t isa)
+{
+    const cpu_put_fn   *bin     = isa == isa_t::ISA_SSE ? sse_bin :
+                                  isa == isa_t::ISA_AVX2 ? avx2_bin :
+                                  avx512_bin;
+
+    tab.isa = isa;
+    if (isa == isa_t::ISA_SCALAR)
+        return;
+
+    tab.swap = sse_swap;
+
+    for (int t = 0; t < (int)scalar_t::TYPE_INTS; t++)
+    {
+        // Types go in pairs of the same size
+        tab.put[t][(int)base_t::BASE_BIN] = bin[t >> 1];
+        // A single 128-bit byte shuffle covers all hexadecimal
+        // digits, wider variants have no more work to share
+        tab.put[t][(int)base_t::BASE_HEX] = sse_hex[t >> 1];
+        tab.get[t][(int)base_t::BASE_HEX] = sse_get_hex[t];
+    }
+}
+#endif //CPU_DISPATCH_X86
+
+// Select kernels at the first use, so a bad environment
+// variable is reported by a running program and not
+// during static initialization
+static void
+cpu_init(void)
+{
+    const char *env     = getenv(CPU_ISA_ENV);
+    isa_t       isa     = cpu_isa_best();
+
+#ifdef CPU_DISPATCH_X86
+    for (int i = 1; i < (int)isa_t::ISA_INVAL; i++)
+        cpu_fill(cpu_tabs[i], (isa_t)i);
+#endif
+
+    if (env != nullptr && *env != '\0')
+    {
+        isa_t req = isa_str2type(env);
+
+        if (req == isa_t::ISA_INVAL)
+            cerr << "cpu_init(): " CPU_ISA_ENV " value '" << env
+                 << "' is invalid." << endl;
+        else if ((int)req > (int)isa)
+            cerr << "cpu_init(): Instruction set '" << env
+                 << "' is not supported by CPU." << endl;
+        else
+            isa = req;
+    }
+
+    cpu_tab.store(&cpu_tabs[(int)isa]);
+}
+
+//////////////////////////////////////////////////////
+// CPU dispatch operations,                         //
+// see definitions in consoleio_cpu.h               //
+//////////////////////////////////////////////////////
+
+// Select kernels and get selected dispatch table
+const cpu_dispatch*
+cpu_select(void)
+{
+    call_once(cpu_once, cpu_init);
+
+    return cpu_tab.load();
+}
+
+// Get instruction set corresponding given name
+isa_t
+isa_str2type(const char *val)
+{
+    if (val == 0)
+        return isa_t::ISA_INVAL;
+
+    for (int i = 0; i < (int)isa_t::ISA_INVAL; i++)
+    {
+        if (strcmp(val, isa_name_s[i]) == 0)
+            return (isa_t)i;
+    }
+
+    return isa_t::ISA_INVAL;
+}
+
+// Get instruction set name
+const char*
+isa_name(isa_t isa)
+{
+    if ((int)isa >= (int)isa_t::ISA_INVAL)
+        return nullptr;
+
+    return isa_name_s[(int)isa];
+}
+
+// Get the best instruction set supported by CPU
+isa_t
+cpu_isa_best(void)
+{
+#ifdef CPU_DISPATCH_X86
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("bmi2"))
+        return isa_t::ISA_AVX512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi2"))
+        return isa_t::ISA_AVX2;
+    if (__builtin_cpu_supports("sse4.2"))
+        return isa_t::ISA_SSE;
+#endif
+
+    return isa_t::ISA_SCALAR;
+}
+
+// Get instruction set of selected kernels
+isa_t
+cpu_isa(void)
+{
+    return cpu_kernels()->isa;
+}
+
+// Select kernels of given instruction set
+int
+cpu_isa_set(isa_t isa)
+{
+    if ((int)isa >= (int)isa_t::ISA_INVAL ||
+        (int)isa > (int)cpu_isa_best())
+    {
+        cerr << "cpu_isa_set(): Instruction set is not supported." << endl;
+        return -1;
+    }
+
+    // Selection at the first use must not override the set
+    cpu_select();
+    cpu_tab.store(&cpu_tabs[(int)isa]);
+
+    return 0;
+}
@@ -0,0 +1,147 @@
+//////////////////////////////////////////////////////////////
+// Runtime CPU dispatch of buffer I/O kernels:              //
+// formatting and parsing of integer values have variants   //
+// for several instruction sets, the best one supported by  //
+// the CPU is selected once at the first use.              //
+//////////////////////////////////////////////////////////////
+#ifndef HAVE_CONSOLEIO_CPU_H
+#define HAVE_CONSOLEIO_CPU_H
+#include "consoleio.h"
+#include <atomic>
+
+//////////////////////////////////////////////////////////////
+// Global library defines                                   //
+//////////////////////////////////////////////////////////////
+
+// Instruction set names in string form
+#define ISA_SCALAR_S    "scalar"
+#define ISA_SSE_S       "sse"
+#define ISA_AVX2_S      "avx2"
+#define ISA_AVX512_S    "avx512"
+
+// Environment variable forcing instruction set,
+// e.g. CONSOLEIO_ISA=sse
+#define CPU_ISA_ENV     "CONSOLEIO_ISA"
+
+//////////////////////////////////////////////////////////////
+// Global library data types                                //
+//////////////////////////////////////////////////////////////
+
+// Instruction set of I/O kernels. Vector kernels are built
+// by GCC and Clang for x86 targets only, other builds use
+// scalar kernels.
+enum class isa_t : uint8_t
+{
+    ISA_SCALAR = 0, // Portable code
+    ISA_SSE,        // SSE4.2 (with SSSE3 byte shuffles)
+    ISA_AVX2,       // AVX2 and BMI2
+    ISA_AVX512,     // AVX-512BW and BMI2
+    ISA_INVAL,
+};
+
+// Kernel putting integer value in raw form into character
+// buffer without digit grouping (see buf_put_int()),
+// scalar type and enumeration base are fixed by kernel.
+//
+// return number of characters put
+typedef int (*cpu_put_fn)(char *buf, uint64_t val);
+
+// Kernel getting integer value from string form
+// (see buf_get_int()).
+//
+// return 0 on success, -1 if string is not handled
+// by the kernel (generic parser is used then)
+typedef int (*cpu_get_fn)(const char *str, size_t len, uint64_t &val);
+
+// Kernel converting array of integer values between byte
+// orders (see endian_swap()) by blocks of 16 bytes.
+//
+// arg[in] size Value size in bytes: 2, 4 or 8
+//
+// return number of converted bytes, the rest
+// is left to generic code
+typedef size_t (*cpu_swap_fn)(void *dst, const void *src, size_t bytes,
+                              int size);
+
+// Dispatch table of kernels keyed by scalar type and
+// enumeration base, nullptr entries use generic code.
+struct cpu_dispatch
+{
+    isa_t       isa;
+    cpu_put_fn  put[(int)scalar_t::TYPE_INTS][(int)base_t::BASE_INVAL];
+    cpu_get_fn  get[(int)scalar_t::TYPE_INTS][(int)base_t::BASE_INVAL];
+    cpu_swap_fn swap;
+};
+
+// Selected dispatch table, nullptr until the first use
+extern std::atomic<const cpu_dispatch *> cpu_tab;
+
+//////////////////////////////////////////////////////////////
+// CPU dispatch operations                                  //
+//////////////////////////////////////////////////////////////
+
+// Select kernels and get selected dispatch table,
+// see cpu_kernels()
+const cpu_dispatch *cpu_select(void);
+
+// Get selected dispatch table, kernels are selected
+// by the first call
+inline const cpu_dispatch*
+cpu_kernels(void)
+{
+    const cpu_dispatch *tab = cpu_tab.load(std::memory_order_acquire);
+
+    return tab != nullptr ? tab : cpu_select();
+}
+
+// Get formatting kernel of scalar type and enumeration base
+//
+// return kernel, nullptr if generic code is used
+inline cpu_put_fn
+cpu_put_kernel(scalar_t type, base_t base)
+{
+    if ((int)type >= (int)scalar_t::TYPE_INTS ||
+        (int)base >= (int)base_t::BASE_INVAL)
+        return nullptr;
+
+    return cpu_kernels()->put[(int)type][(int)base];
+}
+
+// Get parsing kernel of scalar type and enumeration base
+//
+// return kernel, nullptr if generic code is used
+inline cpu_get_fn
+cpu_get_kernel(scalar_t type, base_t base)
+{
+    if ((int)type >= (int)scalar_t::TYPE_INTS ||
+        (int)base >= (int)base_t::BASE_INVAL)
+        return nullptr;
+
+    return cpu_kernels()->get[(int)type][(int)base];
+}
+
+// Get instruction set corresponding given name
+//
+// return instruction set on success,
+// isa_t::ISA_INVAL on fault
+isa_t       isa_str2type(const char *val);
+
+// Get instruction set name
+//
+// return name on success, nullptr on fault
+const char *isa_name(isa_t isa);
+
+// Get the best instruction set supported by CPU
+isa_t       cpu_isa_best(void);
+
+// Get instruction set of selected kernels. Kernels are
+// selected at the first use: the best supported instruction
+// set or the one named by CPU_ISA_ENV environment variable.
+isa_t       cpu_isa(void);
+
+// Select kernels of given instruction set
+//
+// return 0 on success, -1 if the set is not supported
+int         cpu_isa_set(isa_t isa);
+
+#endif //HAVE_CONSOLEIO_CPU_H
@@ -0,0 +1,377 @@
+#include "consoleio_dump.h"
+#include "consoleio_cpu.h"
+#include <vector>
+#include <cstring>
+#include <fcntl.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+//////////////////////////////////////////////////////
+// Module global namespace                          //
+//////////////////////////////////////////////////////
+using namespace std;
+
+//////////////////////////////////////////////////////
+// Module global macros                             //
+//////////////////////////////////////////////////////
+// Byte order of host
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define ENDIAN_HOST endian_t::ENDIAN_BIG
+#else
+#define ENDIAN_HOST endian_t::ENDIAN_LITTLE
+#endif
+
+// Size of data block converted at once
+#define BLOCK_SIZE  4096
+
+// Size of text chunk written onto output stream at once
+#define TEXT_SIZE   (1 << 16)
+
+// Size of chunk read from non-regular files
+#define READ_SIZE   (1 << 20)
+
+//////////////////////////////////////////////////////
+// Module global objects                            //
+//////////////////////////////////////////////////////
+// Byte order name
+static const char*
+endian_name[] = {ENDIAN_LITTLE_S, ENDIAN_BIG_S};
+
+//////////////////////////////////////////////////////
+// Dump operations,                                 //
+// see definitions in consoleio_dump.h              //
+//////////////////////////////////////////////////////
+
+// Get byte order corresponding given name
+endian_t
+endian_str2type(const char *val)
+{
+    if (val == 0)
+        return endian_t::ENDIAN_INVAL;
+
+    for (int i = 0; i < (int)endian_t::ENDIAN_INVAL; i++)
+    {
+        if (strcmp(val, endian_name[i]) == 0)
+            return (endian_t)i;
+    }
+
+    return endian_t::ENDIAN_INVAL;
+}
+
+// Convert array of integer values between byte orders.
+// 16 bytes are converted at once with byte shuffle
+// kernel if the CPU supports it (see consoleio_cpu.h).
+void
+endian_swap(void *dst, const void *src, size_t n, int size)
+{
+    const uint8_t  *s       = (const uint8_t *)src;
+    uint8_t        *d       = (uint8_t *)dst;
+    size_t          bytes   = n * size;
+    size_t          i       = 0;
+
+    if (size <= 1)
+    {
+        if (d != s)
+            memmove(d, s, bytes);
+        return;
+    }
+
+    if (cpu_kernels()->swap != nullptr)
+        i = cpu_kernels()->swap(d, s, bytes, size);
+
+    for (; i < bytes; i += size)
+    {
+        uint8_t v[8];
+
+        for (int j = 0; j < size; j++)
+            v[j] = s[i + size - 1 - j];
+        memcpy(d + i, v, size);
+    }
+}
+
+//////////////////////////////////////////////////////
+// Class 'dump' methods,                            //
+// see definition in consoleio_dump.h               //
+//////////////////////////////////////////////////////
+
+// Constructor
+dump::dump(scalar_t type, base_t base, endian_t endian, int per_line) : \
+           dump_type(type), dump_base(base), dump_endian(endian),       \
+           dump_per_line(per_line)                                      \
+{
+    dump_addr = false;
+    col = 0;
+    offset = 0;
+}
+
+// Put block of data. Values are brought to host byte order
+// by blocks, read in raw form and formatted into text chunk.
+// Decimal values are aligned to the right.
+int
+dump::put_block(ostream &out, const uint8_t *data, size_t size)
+{
+    int         bits    = scalar_bits(dump_type);
+    int         esize   = bits / 8;
+    bool        swap    = dump_endian != ENDIAN_HOST;
+    base        b(dump_base);
+    int         width;
+    int         g       = dump_grp.digits();
+    uint8_t     conv[BLOCK_SIZE];
+    char        text[TEXT_SIZE + 2 * SCALAR_STR_MAX + 2];
+    size_t      pos     = 0;
+
+    switch (esize)
+    {
+        case 1:     width = b.w_char();     break;
+        case 2:     width = b.w_short();    break;
+        case 4:     width = b.w_long();     break;
+        default:    width = b.w_double();   break;
+    }
+    if (dump_base == base_t::BASE_DEC && scalar_is_signed(dump_type))
+        width++;
+    if (g > 0)
+        width += (width - 1) / g;
+
+    while (size > 0)
+    {
+        size_t          len     = size < BLOCK_SIZE ? size : BLOCK_SIZE;
+        const uint8_t  *p       = data;
+
+        if (swap)
+        {
+            endian_swap(conv, data, len / esize, esize);
+            p = conv;
+        }
+
+        for (size_t i = 0; i < len; i += esize)
+        {
+            uint64_t    val     = 0;
+            char        buf[SCALAR_STR_MAX];
+            int         n;
+
+            if (col == 0 && dump_addr)
+            {
+                pos += buf_put_int(text + pos, offset,
+                                   offset >> 32 == 0 ?
+                                   scalar_t::TYPE_ULONG :
+                                   scalar_t::TYPE_UDOUBLE,
+                                   base_t::BASE_HEX);
+            }
+
+            if (col != 0 || dump_addr)
+                text[pos++] = ' ';
+
+            memcpy(&val, p + i, esize);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+            val >>= 64 - bits;
+#endif
+            n = buf_put_int(buf, raw_cast(val, dump_type), dump_type,
+                            dump_base, dump_grp);
+            if (n < 0)
+                return -1;
+            if (n < width)
+            {
+                memset(text + pos, ' ', width - n);
+                pos += width - n;
+            }
+            memcpy(text + pos, buf, n);
+            pos += n;
+
+            offset += esize;
+            if (++col == dump_per_line)
+            {
+                text[pos++] = '\n';
+                col = 0;
+            }
+
+            if (pos >= TEXT_SIZE)
+            {
+                out.write(text, pos);
+                pos = 0;
+            }
+        }
+
+        data += len;
+        size -= len;
+    }
+
+    out.write(text, pos);
+
+    return out.good() ? 0 : -1;
+}
+
+// Finish the last line
+void
+dump::put_end(ostream &out)
+{
+    if (col != 0)
+        out << '\n';
+    col = 0;
+    offset = 0;
+}
+
+// Put dump of memory buffer onto output stream
+int
+dump::put_buf(ostream &out, const void *data, size_t size)
+{
+    int         bits    = scalar_bits(dump_type);
+    size_t      esize;
+    size_t      whole;
+    uint8_t     last[8] = {0,};
+    int         rc;
+
+    if (bits < 0 || (int)dump_base < 0 ||
+        (int)dump_base >= (int)(base_t::BASE_INVAL) ||
+        (int)dump_endian < 0 ||
+        (int)dump_endian >= (int)(endian_t::ENDIAN_INVAL) ||
+        dump_per_line <= 0)
+    {
+        cerr << "dump.put_buf(): Dump settings are invalid." << endl;
+        return -1;
+    }
+
+    esize = bits / 8;
+    whole = size - size % esize;
+    col = 0;
+    offset = 0;
+
+    rc = put_block(out, (const uint8_t *)data, whole);
+    if (rc == 0 && whole != size)
+    {
+        memcpy(last, (const uint8_t *)data + whole, size - whole);
+        rc = put_block(out, last, esize);
+    }
+    put_end(out);
+
+    return rc;
+}
+
+// Put dump of opened file onto output stream
+int
+dump::put_fd(ostream &out, int fd)
+{
+    int             bits    = scalar_bits(dump_type);
+    size_t          esize;
+    vector<uint8_t> buf;
+    size_t          fill    = 0;
+    int             rc      = 0;
+
+    if (bits < 0 || dump_per_line <= 0 ||
+        (int)dump_base < 0 || (int)dump_base >= (int)(base_t::BASE_INVAL) ||
+        (int)dump_endian < 0 ||
+        (int)dump_endian >= (int)(endian_t::ENDIAN_INVAL))
+    {
+        cerr << "dump.put_fd(): Dump settings are invalid." << endl;
+        return -1;
+    }
+
+    esize = bits / 8;
+    col = 0;
+    offset = 0;
+
+#ifndef _WIN32
+    {
+        struct stat st;
+
+        // Regular files are mapped by windows,
+        // so memory use is bounded by window size.
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode))
+        {
+            size_t  size    = (size_t)st.st_size;
+            uint8_t last[8] = {0,};
+
+            for (size_t off = 0; off < size && rc == 0; off += DUMP_WINDOW)
+            {
+                size_t  len     = size - off < DUMP_WINDOW ?
+                                  size - off : DUMP_WINDOW;
+                size_t  whole   = len - len % esize;
+                void   *p       = mmap(nullptr, len, PROT_READ,
+                                       MAP_PRIVATE, fd, (off_t)off);
+
+                if (p == MAP_FAILED)
+                {
+                    cerr << "dump.put_fd(): Failed to map file." << endl;
+                    return -1;
+                }
+                madvise(p, len, MADV_SEQUENTIAL);
+
+                rc = put_block(out, (const uint8_t *)p, whole);
+                if (rc == 0 && whole != len)
+                {
+                    memcpy(last, (const uint8_t *)p + whole, len - whole);
+                    rc = put_block(out, last, esize);
+                }
+
+                munmap(p, len);
+            }
+            put_end(out);
+
+            return rc;
+        }
+    }
+#endif
+
+    // Other files are read by chunks of whole values
+    buf.resize(READ_SIZE);
+    for (;;)
+    {
+        long n = (long)read(fd, buf.data() + fill, (unsigned)(READ_SIZE - fill));
+
+        if (n < 0)
+        {
+            cerr << "dump.put_fd(): Failed to read file." << endl;
+            rc = -1;
+            break;
+        }
+        if (n == 0)
+            break;
+
+        fill += n;
+        if (fill == READ_SIZE)
+        {
+            if (put_block(out, buf.data(), fill) != 0)
+                return -1;
+            fill = 0;
+        }
+    }
+
+    if (rc == 0 && fill != 0)
+    {
+        size_t whole = fill - fill % esize;
+
+        rc = put_block(out, buf.data(), whole);
+        if (rc == 0 && whole != fill)
+        {
+            memset(buf.data() + fill, 0, esize - (fill - whole));
+            rc = put_block(out, buf.data() + whole, esize);
+        }
+    }
+    put_end(out);
+
+    return rc;
+}
+
+// Put dump of file onto output stream
+int
+dump::put_file(ostream &out, const char *path)
+{
+    int fd = open(path, O_RDONLY);
+    int rc;
+
+    if (fd < 0)
+    {
+        cerr << "dump.put_file(): Failed to open file '" << path << "'."
+             << endl;
+        return -1;
+    }
+
+    rc = put_fd(out, fd);
+    close(fd);
+
+    return rc;
+}
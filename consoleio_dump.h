@@ -0,0 +1,126 @@
+//////////////////////////////////////////////////////////////
+// Typed dump of raw binary data ('od'-style):              //
+// memory buffers and files are interpreted as arrays of    //
+// integer values of given scalar type and byte order and   //
+// put onto output stream in given enumeration base.        //
+//////////////////////////////////////////////////////////////
+#ifndef HAVE_CONSOLEIO_DUMP_H
+#define HAVE_CONSOLEIO_DUMP_H
+#include "consoleio.h"
+
+//////////////////////////////////////////////////////////////
+// Global library defines                                   //
+//////////////////////////////////////////////////////////////
+
+// Byte order names in string form
+#define ENDIAN_LITTLE_S "little"
+#define ENDIAN_BIG_S    "big"
+
+// Default byte order of raw binary data
+#define ENDIAN_DFLT     endian_t::ENDIAN_LITTLE
+
+// Default number of values per line
+#define DUMP_PER_LINE_DFLT  8
+
+// Size of file window mapped into memory at once
+#define DUMP_WINDOW     (16 << 20)
+
+//////////////////////////////////////////////////////////////
+// Global library data types                                //
+//////////////////////////////////////////////////////////////
+
+// Byte order of raw binary data
+enum class endian_t
+{
+    ENDIAN_LITTLE = 0,  // Least significant byte first
+    ENDIAN_BIG,         // Most significant byte first
+    ENDIAN_INVAL,
+};
+
+// Class to dump raw binary data as array of integer values.
+// Each line starts with hexadecimal offset of its first
+// value if addresses are enabled. Trailing bytes which do
+// not make a whole value are completed with zeros.
+typedef class dump
+{
+    private:
+        scalar_t    dump_type;      // Scalar value type
+        base_t      dump_base;      // Enumeration base type
+        endian_t    dump_endian;    // Byte order of data
+        int         dump_per_line;  // Number of values per line
+        bool        dump_addr;      // Whether offsets are put
+        group       dump_grp;       // Digit grouping
+        // Output state between blocks of data
+        int         col;            // Values put on current line
+        uint64_t    offset;         // Offset of the next value
+
+        // Put block of data, size is multiple of value size
+        int         put_block(std::ostream &out,
+                              const uint8_t *data, size_t size);
+        // Finish the last line
+        void        put_end(std::ostream &out);
+    public:
+        // Constructor
+        //
+        // arg[in] type     Scalar value type
+        // arg[in] base     Enumeration base type
+        // arg[in] endian   Byte order of data
+        // arg[in] per_line Number of values per line
+        dump(scalar_t type = scalar_t::TYPE_UBYTE,
+             base_t base = base_t::BASE_HEX,
+             endian_t endian = ENDIAN_DFLT,
+             int per_line = DUMP_PER_LINE_DFLT);
+        // Set whether offsets are put at line starts
+        void
+        set_addr(bool addr)
+        {
+            dump_addr = addr;
+        }
+        // Set digit grouping of values
+        void
+        set_group(group grp)
+        {
+            dump_grp = grp;
+        }
+        // Put dump of memory buffer onto output stream.
+        //
+        // arg[in] out      Output stream
+        // arg[in] data     Raw binary data
+        // arg[in] size     Data size in bytes
+        //
+        // return 0 on success, -1 on fault
+        int         put_buf(std::ostream &out, const void *data,
+                            size_t size);
+        // Put dump of file onto output stream. Regular files
+        // are mapped into memory by windows of DUMP_WINDOW
+        // bytes, other files are read by chunks.
+        //
+        // arg[in] out      Output stream
+        // arg[in] path     File path
+        //
+        // return 0 on success, -1 on fault
+        int         put_file(std::ostream &out, const char *path);
+        // The same for opened file descriptor
+        int         put_fd(std::ostream &out, int fd);
+} dump;
+
+//////////////////////////////////////////////////////////////
+// Dump operations                                          //
+//////////////////////////////////////////////////////////////
+
+// Get byte order corresponding given name
+//
+// return byte order on success,
+// endian_t::ENDIAN_INVAL on fault
+endian_t    endian_str2type(const char *val);
+
+// Convert array of integer values of given size between
+// little-endian and big-endian byte order.
+//
+// arg[out] dst     Converted values
+// arg[in]  src     Source values, may be the same as 'dst'
+// arg[in]  n       Number of values
+// arg[in]  size    Size of value in bytes: 1, 2, 4 or 8
+void        endian_swap(void *dst, const void *src, size_t n, int size);
+
+#endif //HAVE_CONSOLEIO_DUMP_H
@@ -0,0 +1,158 @@
+#include "consoleio_gen.h"
+#ifdef CONSOLEIO_HAVE_GEN
+#include <string>
+#include <memory>
+#include <cstring>
+
+//////////////////////////////////////////////////////
+// Module global namespace                          //
+//////////////////////////////////////////////////////
+using namespace std;
+
+//////////////////////////////////////////////////////
+// Module global functions                          //
+//////////////////////////////////////////////////////
+
+// Check whether character is whitespace separator
+static inline bool
+is_space(char c)
+{
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' ||
+           c == '\v' || c == '\f';
+}
+
+// Report invalid token
+//
+// arg[in] tok  Token
+// arg[in] len  Token length
+static void
+token_inval(const char *tok, size_t len)
+{
+    if (len > SCALAR_STR_MAX)
+        len = SCALAR_STR_MAX;
+
+    cerr << "scan(): Token '" << string(tok, len) << "' is invalid."
+         << endl;
+}
+
+//////////////////////////////////////////////////////
+// Generator operations,                            //
+// see definitions in consoleio_gen.h               //
+//////////////////////////////////////////////////////
+
+// Generate integer values parsed from memory buffer
+generator<scalar>
+scan(const char *buf, size_t len, scalar_t type, base_t base)
+{
+    const char *p       = buf;
+    const char *end     = buf + len;
+    scalar      val(type, base);
+
+    while (p < end)
+    {
+        const char *tok;
+        uint64_t    raw;
+
+        while (p < end && is_space(*p))
+            p++;
+        if (p == end)
+            break;
+
+        tok = p;
+        while (p < end && !is_space(*p))
+            p++;
+
+        if (buf_get_int(tok, p - tok, type, base, raw) != 0)
+        {
+            token_inval(tok, p - tok);
+            continue;
+        }
+
+        val.set_raw(raw, type);
+        co_yield val;
+    }
+}
+
+// Generate integer values parsed from input stream. Tokens
+// of each block up to its last whitespace are parsed, the
+// incomplete token at the block end is moved to the buffer
+// start and completed by the next block. Tokens longer than
+// SCALAR_STR_MAX are skipped up to the next whitespace.
+generator<scalar>
+scan(stream &in, scalar_t type, base_t base)
+{
+    unique_ptr<char[]>  buf(new char[GEN_BLOCK + SCALAR_STR_MAX]);
+    size_t              tail    = 0;
+    bool                skip    = false;
+    scalar              val(type, base);
+
+    for (;;)
+    {
+        long long   n       = in.read(buf.get() + tail, GEN_BLOCK);
+        const char *p       = buf.get();
+        const char *end;
+        size_t      len;
+        size_t      cut;
+
+        if (n < 0)
+            co_return;
+
+        len = tail + (size_t)n;
+        cut = len;
+        if (n > 0)
+        {
+            while (cut > 0 && !is_space(buf[cut - 1]))
+                cut--;
+        }
+        end = p + cut;
+
+        // Drop the rest of too long token
+        if (skip)
+        {
+            while (p < end && !is_space(*p))
+                p++;
+            skip = p == end && cut == 0 && n > 0;
+        }
+
+        while (p < end)
+        {
+            const char *tok;
+            uint64_t    raw;
+
+            while (p < end && is_space(*p))
+                p++;
+            if (p == end)
+                break;
+
+            tok = p;
+            while (p < end && !is_space(*p))
+                p++;
+
+            if (buf_get_int(tok, p - tok, type, base, raw) != 0)
+            {
+                token_inval(tok, p - tok);
+                continue;
+            }
+
+            val.set_raw(raw, type);
+            co_yield val;
+        }
+
+        if (n == 0)
+            co_return;
+
+        tail = len - cut;
+        if (skip)
+            tail = 0;
+        else if (tail > SCALAR_STR_MAX)
+        {
+            token_inval(buf.get() + cut, tail);
+            tail = 0;
+            skip = true;
+        }
+        else
+            memmove(buf.get(), buf.get() + cut, tail);
+    }
+}
+
+#endif //CONSOLEIO_HAVE_GEN
@@ -0,0 +1,251 @@
+//////////////////////////////////////////////////////////////
+// Coroutine front-end of input operations (C++20):         //
+// integer values are parsed lazily from streams and        //
+// memory buffers and yielded one at a time, generators     //
+// are composed with filter and transform stages.           //
+//////////////////////////////////////////////////////////////
+#ifndef HAVE_CONSOLEIO_GEN_H
+#define HAVE_CONSOLEIO_GEN_H
+#include "consoleio.h"
+
+// Generators require compiler support of coroutines
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+#define CONSOLEIO_HAVE_GEN
+#include <coroutine>
+#include <exception>
+#include <iterator>
+#include <utility>
+
+//////////////////////////////////////////////////////////////
+// Global library defines                                   //
+//////////////////////////////////////////////////////////////
+
+// Size of input block read from stream at once,
+// generator does not read input between blocks.
+#define GEN_BLOCK   (1 << 16)
+
+//////////////////////////////////////////////////////////////
+// Global library data types                                //
+//////////////////////////////////////////////////////////////
+
+// Class of coroutine generating sequence of values.
+// Generator is move-only, it is iterated once by
+// range-based for loop:
+//
+//  for (const scalar &val : scan(in, type, base))
+//      ...
+template <typename T>
+class generator
+{
+    public:
+        // Coroutine promise keeping the last yielded value
+        struct promise_type
+        {
+            const T            *value = nullptr;
+            std::exception_ptr  error;
+
+            generator
+            get_return_object(void)
+            {
+                return generator(handle::from_promise(*this));
+            }
+            std::suspend_always
+            initial_suspend(void) noexcept
+            {
+                return {};
+            }
+            std::suspend_always
+            final_suspend(void) noexcept
+            {
+                return {};
+            }
+            // Yielded value lives in coroutine frame or is
+            // a temporary alive until coroutine is resumed.
+            std::suspend_always
+            yield_value(const T &val) noexcept
+            {
+                value = &val;
+                return {};
+            }
+            void
+            return_void(void)
+            {
+            }
+            void
+            unhandled_exception(void)
+            {
+                error = std::current_exception();
+            }
+        };
+
+        using handle = std::coroutine_handle<promise_type>;
+
+        // Input iterator over generated values
+        class iterator
+        {
+            private:
+                handle  coro;
+            public:
+                iterator(handle h = nullptr) : coro(h) {};
+                const T&
+                operator*(void) const
+                {
+                    return *coro.promise().value;
+                }
+                const T*
+                operator->(void) const
+                {
+                    return coro.promise().value;
+                }
+                iterator&
+                operator++(void)
+                {
+                    next(coro);
+                    return *this;
+                }
+                void
+                operator++(int)
+                {
+                    ++*this;
+                }
+                bool
+                operator==(std::default_sentinel_t) const
+                {
+                    return !coro || coro.done();
+                }
+        };
+
+    private:
+        handle  coro;
+
+        // Resume coroutine up to the next value
+        static void
+        next(handle h)
+        {
+            h.resume();
+            if (h.done() && h.promise().error)
+                std::rethrow_exception(h.promise().error);
+        }
+    public:
+        // Constructors and destructor
+        explicit generator(handle h) : coro(h) {};
+        generator(const generator &) = delete;
+        generator(generator &&src) noexcept : \
+            coro(std::exchange(src.coro, nullptr)) {};
+        generator&
+        operator=(generator &&src) noexcept
+        {
+            if (this != &src)
+            {
+                if (coro)
+                    coro.destroy();
+                coro = std::exchange(src.coro, nullptr);
+            }
+            return *this;
+        }
+        ~generator()
+        {
+            if (coro)
+                coro.destroy();
+        }
+        // Start generation and get iterator
+        // to the first value
+        iterator
+        begin(void)
+        {
+            if (coro)
+                next(coro);
+            return iterator(coro);
+        }
+        std::default_sentinel_t
+        end(void)
+        {
+            return {};
+        }
+};
+
+// Generator stage keeping values satisfying predicate
+template <typename P>
+struct gen_filter
+{
+    P   pred;
+};
+
+// Generator stage replacing values by function results
+template <typename F>
+struct gen_transform
+{
+    F   fn;
+};
+
+//////////////////////////////////////////////////////////////
+// Generator operations                                     //
+//////////////////////////////////////////////////////////////
+
+// Generate integer values of given scalar type parsed from
+// input stream in given enumeration base. Input is read by
+// blocks of GEN_BLOCK bytes, tokens split between blocks are
+// joined. Invalid tokens are reported and skipped.
+//
+// arg[in] in   Input stream, must live while
+//              values are generated
+// arg[in] type Scalar value type
+// arg[in] base Enumeration base type
+//
+// return generator of scalar values
+generator<scalar>   scan(stream &in, scalar_t type, base_t base);
+
+// The same for memory buffer
+//
+// arg[in] buf  Text, must live while values are generated
+// arg[in] len  Text length
+generator<scalar>   scan(const char *buf, size_t len,
+                         scalar_t type, base_t base);
+
+// Make filter stage of generator pipeline:
+//
+//  scan(in, type, base) | filter([](const scalar &v) {...})
+//
+// arg[in] pred Predicate taking generated value
+template <typename P>
+gen_filter<P>
+filter(P pred)
+{
+    return gen_filter<P>{std::move(pred)};
+}
+
+// Make transform stage of generator pipeline
+//
+// arg[in] fn   Function taking generated value
+template <typename F>
+gen_transform<F>
+transform(F fn)
+{
+    return gen_transform<F>{std::move(fn)};
+}
+
+// Pipe generator into filter stage, values are
+// passed through without copies into containers.
+template <typename T, typename P>
+generator<T>
+operator|(generator<T> src, gen_filter<P> stage)
+{
+    for (const T &val : src)
+    {
+        if (stage.pred(val))
+            co_yield val;
+    }
+}
+
+// Pipe generator into transform stage
+template <typename T, typename F>
+auto
+operator|(generator<T> src, gen_transform<F> stage)
+    -> generator<std::decay_t<decltype(stage.fn(std::declval<const T&>()))>>
+{
+    for (const T &val : src)
+        co_yield stage.fn(val);
+}
+
+#endif //__cpp_impl_coroutine
+#endif //HAVE_CONSOLEIO_GEN_H
@@ -0,0 +1,255 @@
+#include "consoleio_parser.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+//////////////////////////////////////////////////////
+// Module global namespace                          //
+//////////////////////////////////////////////////////
+using namespace std;
+
+//////////////////////////////////////////////////////
+// Module global functions                          //
+//////////////////////////////////////////////////////
+
+// Check whether character is whitespace separator
+static inline bool
+is_space(char c)
+{
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' ||
+           c == '\v' || c == '\f';
+}
+
+// Check whether file descriptor is non-blocking
+static bool
+fd_nonblock(int fd)
+{
+#ifdef _WIN32
+    (void)fd;
+    return false;
+#else
+    int flags = fcntl(fd, F_GETFL);
+
+    return flags >= 0 && (flags & O_NONBLOCK) != 0;
+#endif
+}
+
+//////////////////////////////////////////////////////
+// Class 'parser' methods,                          //
+// see definition in consoleio_parser.h             //
+//////////////////////////////////////////////////////
+
+// Constructor
+parser::parser(scalar_t type, base_t base, size_t batch) : \
+               parser_type(type), parser_base(base)         \
+{
+    if (batch == 0)
+        batch = 1;
+
+    vals = new scalar[batch];
+    for (size_t i = 0; i < batch; i++)
+        vals[i] = scalar(type, base);
+    vals_max = batch;
+    rbuf = new char[PARSER_READ_SIZE];
+
+    reset();
+}
+
+// Destructor
+parser::~parser()
+{
+    delete[] vals;
+    delete[] rbuf;
+}
+
+// Drop batch, incomplete token, read data
+// and detected descriptor mode
+void
+parser::reset(void)
+{
+    vals_n = 0;
+    errs = 0;
+    tok_len = 0;
+    rbuf_pos = 0;
+    rbuf_len = 0;
+    pull_fd = -1;
+    pull_nonblock = false;
+}
+
+// Parse complete token and add it to batch
+void
+parser::put_token(const char *str, size_t len)
+{
+    uint64_t raw;
+
+    if (buf_get_int(str, len, parser_type, parser_base, raw) != 0)
+    {
+        errs++;
+        return;
+    }
+
+    vals[vals_n++].set_raw(raw, parser_type);
+}
+
+// Feed chunk of text. Tokens inside the chunk are parsed
+// in place, only a token split at the chunk end is copied.
+// Parsing stops before a token is completed into full batch.
+size_t
+parser::feed(const char *buf, size_t len)
+{
+    const char *p       = buf;
+    const char *end     = buf + len;
+
+    while (p < end)
+    {
+        const char *s;
+
+        if (tok_len == 0)
+        {
+            while (p < end && is_space(*p))
+                p++;
+            if (p == end || vals_n == vals_max)
+                break;
+
+            s = p;
+            while (p < end && !is_space(*p))
+                p++;
+
+            if (p < end)
+            {
+                put_token(s, p - s);
+                continue;
+            }
+
+            // Keep token split at the chunk end
+            if (p - s <= SCALAR_STR_MAX)
+            {
+                memcpy(tok, s, p - s);
+                tok_len = (int)(p - s);
+            }
+            else
+            {
+                errs++;
+                tok_len = -1;
+            }
+            break;
+        }
+
+        // Continue incomplete token
+        s = p;
+        while (p < end && !is_space(*p))
+            p++;
+
+        if (tok_len > 0)
+        {
+            if (tok_len + (p - s) <= SCALAR_STR_MAX)
+            {
+                memcpy(tok + tok_len, s, p - s);
+                tok_len += (int)(p - s);
+            }
+            else
+            {
+                errs++;
+                tok_len = -1;
+            }
+        }
+
+        if (p == end || vals_n == vals_max)
+            break;
+
+        if (tok_len > 0)
+            put_token(tok, tok_len);
+        tok_len = 0;
+    }
+
+    return p - buf;
+}
+
+// Finish input
+int
+parser::finish(void)
+{
+    if (tok_len > 0)
+    {
+        if (vals_n == vals_max)
+            return -1;
+        put_token(tok, tok_len);
+    }
+    tok_len = 0;
+
+    return 0;
+}
+
+// Bind parser to file descriptor and detect its mode
+void
+parser::open(int fd)
+{
+    reset();
+    set_nonblock(fd, fd_nonblock(fd));
+}
+
+// Read available data from file descriptor and parse it.
+// Blocking descriptors are read at most once per call and
+// not at all if the call parses data left by a full batch.
+parser_state_t
+parser::pull(int fd)
+{
+    if (fd != pull_fd)
+        set_nonblock(fd, fd_nonblock(fd));
+
+    for (;;)
+    {
+        long n;
+
+        if (rbuf_pos < rbuf_len)
+        {
+            rbuf_pos += feed(rbuf + rbuf_pos, rbuf_len - rbuf_pos);
+            if (rbuf_pos < rbuf_len || vals_n == vals_max)
+                return parser_state_t::PARSER_FULL;
+            if (!pull_nonblock)
+                return parser_state_t::PARSER_MORE;
+        }
+
+        if (vals_n == vals_max)
+            return parser_state_t::PARSER_FULL;
+
+        n = (long)read(fd, rbuf, PARSER_READ_SIZE);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return parser_state_t::PARSER_AGAIN;
+
+            cerr << "parser.pull(): Failed to read input." << endl;
+            pull_fd = -1;
+            return parser_state_t::PARSER_ERROR;
+        }
+
+        // Descriptor is likely closed after its end,
+        // its number may be reused by another one
+        if (n == 0)
+        {
+            if (finish() != 0)
+                return parser_state_t::PARSER_FULL;
+            pull_fd = -1;
+            return parser_state_t::PARSER_EOF;
+        }
+
+        rbuf_pos = 0;
+        rbuf_len = (size_t)n;
+
+        if (!pull_nonblock)
+        {
+            rbuf_pos += feed(rbuf, rbuf_len);
+            return rbuf_pos < rbuf_len || vals_n == vals_max ?
+                   parser_state_t::PARSER_FULL :
+                   parser_state_t::PARSER_MORE;
+        }
+    }
+}
@@ -0,0 +1,168 @@
+//////////////////////////////////////////////////////////////
+// Resumable incremental parser of integer values:          //
+// text arrives by chunks split at any position (sockets,   //
+// pipes), partial tokens are kept between calls, parsed    //
+// values are collected into batches. The parser never      //
+// blocks and does not allocate memory per chunk.           //
+//////////////////////////////////////////////////////////////
+#ifndef HAVE_CONSOLEIO_PARSER_H
+#define HAVE_CONSOLEIO_PARSER_H
+#include "consoleio.h"
+
+//////////////////////////////////////////////////////////////
+// Global library defines                                   //
+//////////////////////////////////////////////////////////////
+
+// Default number of values in batch
+#define PARSER_BATCH_DFLT   1024
+
+// Size of chunk read from file descriptor at once
+#define PARSER_READ_SIZE    (1 << 16)
+
+//////////////////////////////////////////////////////////////
+// Global library data types                                //
+//////////////////////////////////////////////////////////////
+
+// State of parser input
+enum class parser_state_t
+{
+    PARSER_MORE = 0,    // More input is expected
+    PARSER_FULL,        // Batch is full, drain it to go on
+    PARSER_AGAIN,       // Descriptor has no data now (EAGAIN)
+    PARSER_EOF,         // End of input
+    PARSER_ERROR,       // Read fault
+};
+
+// Class to parse integer values of given scalar type from
+// text in given enumeration base fed by chunks. Whitespace
+// separated tokens may be split between chunks at any byte,
+// the incomplete token is kept in a fixed buffer. Values
+// are put into preallocated batch, feeding stops when the
+// batch is full. Typical event loop use:
+//
+//  on readable fd:
+//      while (p.pull(fd) == PARSER_FULL)
+//          handle(p.batch(), p.size()), p.clear();
+//      handle(p.batch(), p.size()), p.clear();
+typedef class parser
+{
+    private:
+        scalar_t    parser_type;    // Scalar value type
+        base_t      parser_base;    // Enumeration base type
+        // Batch of parsed values
+        scalar     *vals;
+        size_t      vals_max;
+        size_t      vals_n;
+        uint64_t    errs;           // Number of invalid tokens
+        // Incomplete token, too long
+        // tokens are skipped up to the
+        // next whitespace (tok_len < 0)
+        char        tok[SCALAR_STR_MAX];
+        int         tok_len;
+        // Read buffer and its unparsed part
+        char       *rbuf;
+        size_t      rbuf_pos;
+        size_t      rbuf_len;
+        // Descriptor of the last pull() and its
+        // mode, detected once per descriptor
+        int         pull_fd;
+        bool        pull_nonblock;
+
+        // Parse complete token and add it to batch
+        void        put_token(const char *str, size_t len);
+    public:
+        // Constructor, batch and read buffer
+        // are allocated once here.
+        //
+        // arg[in] type     Scalar value type
+        // arg[in] base     Enumeration base type
+        // arg[in] batch    Number of values in batch
+        parser(scalar_t type = SCALAR_DFLT, base_t base = BASE_DFLT,
+               size_t batch = PARSER_BATCH_DFLT);
+        ~parser();
+        parser(const parser &) = delete;
+        parser &operator=(const parser &) = delete;
+        // Feed chunk of text. Parsing stops when batch
+        // is full, the rest of the chunk must be fed
+        // again after the batch is drained.
+        //
+        // arg[in] buf  Text chunk
+        // arg[in] len  Chunk length
+        //
+        // return number of consumed bytes
+        size_t      feed(const char *buf, size_t len);
+        // Finish input: incomplete token is parsed
+        // as the last one.
+        //
+        // return 0 on success, -1 if batch is full
+        int         finish(void);
+        // Bind parser to file descriptor: parser state is
+        // dropped and the mode of descriptor is detected.
+        // A descriptor number reused after close() before
+        // the end of input is reached must be bound again.
+        //
+        // arg[in] fd   File descriptor
+        void        open(int fd);
+        // Read available data from file descriptor and
+        // parse it until batch is full or descriptor has
+        // no more data. Non-blocking descriptors return
+        // PARSER_AGAIN when drained, blocking ones return
+        // after each read and do not read in a call that
+        // parses data left by a full batch. Unparsed data
+        // of the last read is kept and parsed by the next
+        // call.
+        //
+        // The mode of descriptor is detected by open() or
+        // the first call for it, see set_nonblock().
+        //
+        // arg[in] fd   File descriptor
+        //
+        // return parser state
+        parser_state_t  pull(int fd);
+        // Set mode of descriptor read by pull(), e.g.
+        // after the mode is changed by caller
+        //
+        // arg[in] fd       File descriptor
+        // arg[in] nonblock Whether descriptor is non-blocking
+        void
+        set_nonblock(int fd, bool nonblock)
+        {
+            pull_fd = fd;
+            pull_nonblock = nonblock;
+        }
+        // Get batch of parsed values
+        const scalar*
+        batch(void)
+        {
+            return vals;
+        }
+        // Get number of values in batch
+        size_t
+        size(void)
+        {
+            return vals_n;
+        }
+        // Check whether batch is full
+        bool
+        full(void)
+        {
+            return vals_n == vals_max;
+        }
+        // Drain batch
+        void
+        clear(void)
+        {
+            vals_n = 0;
+        }
+        // Get number of invalid tokens
+        uint64_t
+        errors(void)
+        {
+            return errs;
+        }
+        // Drop batch, incomplete token, read data
+        // and detected descriptor mode
+        void        reset(void);
+} parser;
+
+#endif //HAVE_CONSOLEIO_PARSER_H
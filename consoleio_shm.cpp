@@ -0,0 +1,535 @@
+#include "consoleio_shm.h"
+#include <new>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <ctime>
+#endif
+#endif
+
+//////////////////////////////////////////////////////
+// Module global namespace                          //
+//////////////////////////////////////////////////////
+using namespace std;
+
+// Futex words are used in place
+static_assert(sizeof(atomic<uint32_t>) == sizeof(uint32_t),
+              "atomic futex word must be 32-bit");
+static_assert(sizeof(shm_ring_hdr) % 64 == 0,
+              "ring slots must start at cache line");
+
+//////////////////////////////////////////////////////
+// Module global functions                          //
+//////////////////////////////////////////////////////
+
+// Wait while futex word keeps given value, the wait
+// is limited by SHM_WAIT_MS. Other POSIX systems
+// poll the word.
+static void
+shm_wait(atomic<uint32_t> &word, uint32_t val)
+{
+#if defined(__linux__)
+    struct timespec ts = {0, SHM_WAIT_MS * 1000000L};
+
+    syscall(SYS_futex, (uint32_t *)&word, FUTEX_WAIT, val, &ts,
+            nullptr, 0);
+#elif !defined(_WIN32)
+    for (int i = 0; i < SHM_WAIT_MS && word.load() == val; i++)
+        usleep(1000);
+#else
+    (void)word;
+    (void)val;
+#endif
+}
+
+// Wake side waiting on futex word
+static void
+shm_wake(atomic<uint32_t> &word)
+{
+#if defined(__linux__)
+    syscall(SYS_futex, (uint32_t *)&word, FUTEX_WAKE, INT_MAX, nullptr,
+            nullptr, 0);
+#else
+    (void)word;
+#endif
+}
+
+//////////////////////////////////////////////////////
+// Class 'shm_ring' methods,                        //
+// see definition in consoleio_shm.h                //
+//////////////////////////////////////////////////////
+
+// Constructor
+shm_ring::shm_ring()
+{
+    hdr = nullptr;
+    slots = nullptr;
+    map_len = 0;
+    mask = 0;
+    producer = false;
+    head_local = tail_cache = 0;
+    tail_local = head_cache = 0;
+}
+
+// Destructor
+shm_ring::~shm_ring()
+{
+    close();
+}
+
+// Create or attach named ring. Created ring gets its
+// header before the magic string, so attaching side
+// never sees partially set up ring.
+int
+shm_ring::open(const char *name, bool create, size_t capacity)
+{
+#ifdef _WIN32
+    (void)name;
+    (void)create;
+    (void)capacity;
+    cerr << "shm_ring.open(): Shared memory rings are not supported."
+         << endl;
+    return -1;
+#else
+    struct stat st;
+    void       *p;
+    int         fd;
+
+    close();
+
+    if (name == nullptr || capacity == 0 || capacity > SHM_RING_MAX)
+    {
+        cerr << "shm_ring.open(): Ring name or capacity is invalid."
+             << endl;
+        return -1;
+    }
+
+    if (create)
+    {
+        size_t cap = 2;
+
+        while (cap < capacity)
+            cap <<= 1;
+
+        map_len = sizeof(shm_ring_hdr) + cap * sizeof(scalar);
+        // Ring in use must not be reset
+        fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0 && errno == EEXIST)
+        {
+            cerr << "shm_ring.open(): Ring '" << name
+                 << "' already exists." << endl;
+            return -1;
+        }
+        if (fd >= 0 && ftruncate(fd, (off_t)map_len) != 0)
+        {
+            ::close(fd);
+            shm_unlink(name);
+            fd = -1;
+        }
+        capacity = cap;
+    }
+    else
+        fd = shm_open(name, O_RDWR, 0);
+
+    if (fd < 0)
+    {
+        cerr << "shm_ring.open(): Failed to open ring '" << name << "'."
+             << endl;
+        return -1;
+    }
+
+    if (!create)
+    {
+        if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(shm_ring_hdr))
+        {
+            cerr << "shm_ring.open(): Ring '" << name << "' is invalid."
+                 << endl;
+            ::close(fd);
+            return -1;
+        }
+        map_len = (size_t)st.st_size;
+    }
+
+    p = mmap(nullptr, map_len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED)
+    {
+        cerr << "shm_ring.open(): Failed to map ring '" << name << "'."
+             << endl;
+        if (create)
+            shm_unlink(name);
+        return -1;
+    }
+
+    hdr = (shm_ring_hdr *)p;
+    ring_name = name;
+
+    if (create)
+    {
+        new (hdr) shm_ring_hdr();
+        memcpy(hdr->magic, SHM_MAGIC, SHM_MAGIC_LEN);
+        hdr->slot_size = sizeof(scalar);
+        hdr->capacity = capacity;
+        hdr->head.store(0);
+        hdr->head_seq.store(0);
+        hdr->cons_wait.store(0);
+        hdr->closed.store(0);
+        hdr->tail.store(0);
+        hdr->tail_seq.store(0);
+        hdr->prod_wait.store(0);
+        hdr->users.store(1);
+        hdr->joined.store(0);
+        hdr->ready.store(1, memory_order_release);
+    }
+    else
+    {
+        // The header is read after it is published by creator
+        if (hdr->ready.load(memory_order_acquire) == 0 ||
+            memcmp(hdr->magic, SHM_MAGIC, SHM_MAGIC_LEN) != 0 ||
+            hdr->slot_size != sizeof(scalar) ||
+            hdr->capacity < 2 || hdr->capacity > SHM_RING_MAX ||
+            (hdr->capacity & (hdr->capacity - 1)) != 0 ||
+            sizeof(shm_ring_hdr) + hdr->capacity * sizeof(scalar) > map_len)
+        {
+            cerr << "shm_ring.open(): Ring '" << name
+                 << "' is not ready, invalid or built with other scalar "
+                    "size." << endl;
+            munmap(p, map_len);
+            hdr = nullptr;
+            map_len = 0;
+            return -1;
+        }
+
+        hdr->users.fetch_add(1);
+        hdr->joined.store(1);
+    }
+
+    slots = (scalar *)(hdr + 1);
+    mask = hdr->capacity - 1;
+    producer = false;
+    head_local = tail_cache = hdr->head.load(memory_order_acquire);
+    tail_local = head_cache = hdr->tail.load(memory_order_acquire);
+
+    return 0;
+#endif
+}
+
+// Detach ring. The name is removed by the last side
+// detaching once both sides attached, a creator leaving
+// before the other side attaches keeps the ring. Both
+// futex words are bumped, so the other side rechecks
+// the ring whatever it waits for.
+void
+shm_ring::close(void)
+{
+    bool last;
+
+    if (hdr == nullptr)
+        return;
+
+    if (producer)
+        finish();
+    else
+        release();
+
+    last = hdr->users.fetch_sub(1) == 1 && hdr->joined.load() != 0;
+
+    hdr->head_seq.fetch_add(1);
+    hdr->tail_seq.fetch_add(1);
+    shm_wake(hdr->head_seq);
+    shm_wake(hdr->tail_seq);
+
+#ifndef _WIN32
+    munmap((void *)hdr, map_len);
+    if (last)
+        shm_unlink(ring_name.c_str());
+#else
+    (void)last;
+#endif
+
+    hdr = nullptr;
+    slots = nullptr;
+    map_len = 0;
+    producer = false;
+}
+
+// Publish staged values and wake consumer. The sequence
+// is bumped after the head, so a consumer going to sleep
+// either sees the new head or fails its futex wait.
+void
+shm_ring::publish(void)
+{
+    if (hdr->head.load(memory_order_relaxed) == head_local)
+        return;
+
+    hdr->head.store(head_local, memory_order_release);
+    hdr->head_seq.fetch_add(1);
+    if (hdr->cons_wait.load() != 0)
+        shm_wake(hdr->head_seq);
+}
+
+// Release consumed slots and wake producer
+void
+shm_ring::release(void)
+{
+    if (hdr->tail.load(memory_order_relaxed) == tail_local)
+        return;
+
+    hdr->tail.store(tail_local, memory_order_release);
+    hdr->tail_seq.fetch_add(1);
+    if (hdr->prod_wait.load() != 0)
+        shm_wake(hdr->tail_seq);
+}
+
+// Check whether the other side detached. The creator
+// alone waits for the other side to attach.
+bool
+shm_ring::peer_gone(void)
+{
+    return hdr->joined.load() != 0 && hdr->users.load() < 2;
+}
+
+// Wait for free slots
+uint64_t
+shm_ring::wait_space(void)
+{
+    for (;;)
+    {
+        uint64_t    used    = head_local - tail_cache;
+        uint32_t    seq;
+
+        if (used <= mask)
+            return mask + 1 - used;
+
+        // Staged values must be seen by consumer to be drained
+        publish();
+
+        seq = hdr->tail_seq.load();
+        tail_cache = hdr->tail.load(memory_order_acquire);
+        if (head_local - tail_cache <= mask)
+            continue;
+
+        // Nobody drains the ring
+        if (peer_gone())
+            return 0;
+
+        hdr->prod_wait.store(1);
+        shm_wait(hdr->tail_seq, seq);
+        hdr->prod_wait.store(0);
+    }
+}
+
+// Wait for published values
+uint64_t
+shm_ring::wait_data(void)
+{
+    for (;;)
+    {
+        uint32_t seq;
+
+        if (head_cache != tail_local)
+            return head_cache - tail_local;
+
+        // Consumed slots are given back before sleeping
+        release();
+
+        seq = hdr->head_seq.load();
+        head_cache = hdr->head.load(memory_order_acquire);
+        if (head_cache != tail_local)
+            continue;
+
+        if (hdr->closed.load(memory_order_acquire) != 0 || peer_gone())
+        {
+            head_cache = hdr->head.load(memory_order_acquire);
+            if (head_cache == tail_local)
+                return 0;
+            continue;
+        }
+
+        hdr->cons_wait.store(1);
+        shm_wait(hdr->head_seq, seq);
+        hdr->cons_wait.store(0);
+    }
+}
+
+// Put value
+int
+shm_ring::push(const scalar &val)
+{
+    if (hdr == nullptr)
+    {
+        cerr << "shm_ring.push(): Ring is not open." << endl;
+        return -1;
+    }
+
+    producer = true;
+    if (head_local - tail_cache > mask && wait_space() == 0)
+    {
+        cerr << "shm_ring.push(): Ring consumer is gone." << endl;
+        return -1;
+    }
+
+    slots[head_local & mask] = val;
+    head_local++;
+
+    if (head_local - hdr->head.load(memory_order_relaxed) >= SHM_BATCH)
+        publish();
+
+    return 0;
+}
+
+// Put values and publish them
+int
+shm_ring::put(const scalar *vals, size_t n)
+{
+    if (hdr == nullptr)
+    {
+        cerr << "shm_ring.put(): Ring is not open." << endl;
+        return -1;
+    }
+
+    producer = true;
+    while (n != 0)
+    {
+        uint64_t free = wait_space();
+        size_t   k    = n < free ? n : (size_t)free;
+
+        if (free == 0)
+        {
+            cerr << "shm_ring.put(): Ring consumer is gone." << endl;
+            return -1;
+        }
+
+        for (size_t i = 0; i < k; i++)
+            slots[(head_local + i) & mask] = vals[i];
+        head_local += k;
+        vals += k;
+        n -= k;
+
+        publish();
+    }
+
+    return 0;
+}
+
+// Publish staged values
+void
+shm_ring::flush(void)
+{
+    if (hdr != nullptr)
+        publish();
+}
+
+// Mark the end of values
+void
+shm_ring::finish(void)
+{
+    if (hdr == nullptr)
+        return;
+
+    publish();
+    hdr->closed.store(1, memory_order_release);
+    hdr->head_seq.fetch_add(1);
+    if (hdr->cons_wait.load() != 0)
+        shm_wake(hdr->head_seq);
+}
+
+// Get value
+int
+shm_ring::pop(scalar &val)
+{
+    if (hdr == nullptr)
+    {
+        cerr << "shm_ring.pop(): Ring is not open." << endl;
+        return -1;
+    }
+
+    if (head_cache == tail_local && wait_data() == 0)
+        return -1;
+
+    val = slots[tail_local & mask];
+    tail_local++;
+
+    if (tail_local - hdr->tail.load(memory_order_relaxed) >= SHM_BATCH)
+        release();
+
+    return 0;
+}
+
+// Get available values
+size_t
+shm_ring::get(scalar *vals, size_t n)
+{
+    uint64_t    avail;
+    size_t      k;
+
+    if (hdr == nullptr)
+    {
+        cerr << "shm_ring.get(): Ring is not open." << endl;
+        return 0;
+    }
+
+    avail = wait_data();
+    k = n < avail ? n : (size_t)avail;
+
+    for (size_t i = 0; i < k; i++)
+        vals[i] = slots[(tail_local + i) & mask];
+    tail_local += k;
+
+    release();
+
+    return k;
+}
+
+//////////////////////////////////////////////////////
+// Class stream shared memory methods,              //
+// see definition in consoleio.h                    //
+//////////////////////////////////////////////////////
+
+// Destructor, shared memory ring is detached
+stream::~stream()
+{
+    close_shm();
+}
+
+// Create or attach shared memory ring
+int
+stream::open_shm(const char *name, bool create, size_t capacity)
+{
+    close_shm();
+
+    stream_ring = new shm_ring();
+    if (stream_ring->open(name, create, capacity) != 0)
+    {
+        delete stream_ring;
+        stream_ring = nullptr;
+        return -1;
+    }
+
+    stream_type = stream_t::STREAM_SHM;
+
+    return 0;
+}
+
+// Detach shared memory ring
+void
+stream::close_shm(void)
+{
+    if (stream_ring == nullptr)
+        return;
+
+    delete stream_ring;
+    stream_ring = nullptr;
+
+    // Stream is left without I/O until its type is set
+    if (stream_type == stream_t::STREAM_SHM)
+        stream_type = stream_t::STREAM_INVAL;
+}
@@ -0,0 +1,163 @@
+//////////////////////////////////////////////////////////////
+// Shared memory transport of scalar values:                //
+// single producer single consumer ring buffer in named     //
+// POSIX shared memory carries scalar values in native      //
+// form between processes of one host, waiting sides are    //
+// woken through futex (Linux).                             //
+//////////////////////////////////////////////////////////////
+#ifndef HAVE_CONSOLEIO_SHM_H
+#define HAVE_CONSOLEIO_SHM_H
+#include "consoleio.h"
+#include <atomic>
+#include <string>
+
+//////////////////////////////////////////////////////////////
+// Global library defines                                   //
+//////////////////////////////////////////////////////////////
+
+// Magic string of ring header
+#define SHM_MAGIC       "CIORING1"
+#define SHM_MAGIC_LEN   8
+
+// Maximal number of ring slots, the number is rounded
+// up to a power of two (see SHM_RING_DFLT)
+#define SHM_RING_MAX    (1 << 28)
+
+// Number of values published or consumed at once
+// by push() and pop(), see flush()
+#define SHM_BATCH       256
+
+// Period of rechecks of waiting sides, milliseconds
+#define SHM_WAIT_MS     100
+
+//////////////////////////////////////////////////////////////
+// Global library data types                                //
+//////////////////////////////////////////////////////////////
+
+// Ring header at the start of shared memory object, ring
+// slots follow it. Producer and consumer fields are kept
+// on separate cache lines.
+struct shm_ring_hdr
+{
+    char                    magic[SHM_MAGIC_LEN];   // SHM_MAGIC
+    uint32_t                slot_size;  // sizeof(scalar) of creator
+    uint32_t                pad;
+    uint64_t                capacity;   // Number of slots
+    std::atomic<uint32_t>   ready;      // Header is set up
+    std::atomic<uint32_t>   users;      // Number of attached sides
+    std::atomic<uint32_t>   joined;     // The other side attached
+    // Producer side
+    alignas(64)
+    std::atomic<uint64_t>   head;       // Number of published values
+    std::atomic<uint32_t>   head_seq;   // Futex word bumped on publish
+    std::atomic<uint32_t>   cons_wait;  // Consumer is waiting
+    std::atomic<uint32_t>   closed;     // Producer put the last value
+    // Consumer side
+    alignas(64)
+    std::atomic<uint64_t>   tail;       // Number of consumed values
+    std::atomic<uint32_t>   tail_seq;   // Futex word bumped on consume
+    std::atomic<uint32_t>   prod_wait;  // Producer is waiting
+};
+
+// Class of shared memory ring of scalar values. One process
+// puts values, another one gets them. Single values are
+// staged and published by batches of SHM_BATCH values,
+// so the shared indexes are touched once per batch and
+// a wakeup system call is made only for a waiting side.
+typedef class shm_ring
+{
+    private:
+        shm_ring_hdr   *hdr;        // Mapped shared memory
+        scalar         *slots;
+        size_t          map_len;
+        uint64_t        mask;       // capacity - 1
+        std::string     ring_name;
+        bool            producer;   // Values are put by this side
+        // Producer state
+        uint64_t        head_local; // Staged values end
+        uint64_t        tail_cache; // The last seen tail
+        // Consumer state
+        uint64_t        tail_local; // Consumed values end
+        uint64_t        head_cache; // The last seen head
+
+        // Publish staged values and wake consumer
+        void        publish(void);
+        // Release consumed slots and wake producer
+        void        release(void);
+        // Check whether the other side detached
+        // after it attached
+        bool        peer_gone(void);
+        // Wait for free slots
+        //
+        // return number of free slots, 0 if consumer is gone
+        uint64_t    wait_space(void);
+        // Wait for published values
+        //
+        // return number of available values, 0 at the end
+        // or if producer is gone
+        uint64_t    wait_data(void);
+    public:
+        // Constructor
+        shm_ring();
+        ~shm_ring();
+        shm_ring(const shm_ring &) = delete;
+        shm_ring &operator=(const shm_ring &) = delete;
+        // Create or attach named ring. The name must not exist
+        // when the ring is created, it is removed by the last
+        // side detaching after the other side attached, so
+        // values put before the other side attaches are kept.
+        //
+        // arg[in] name     Shared memory object name, e.g. "/ring"
+        // arg[in] create   Whether the ring is created
+        // arg[in] capacity Number of slots of created ring
+        //
+        // return 0 on success, -1 on fault
+        int         open(const char *name, bool create,
+                         size_t capacity = SHM_RING_DFLT);
+        // Detach ring and wake the other side. Detaching of
+        // any side ends values for the other one: consumer
+        // gets the rest of values and the end, producer
+        // fails to put values into full ring.
+        void        close(void);
+        // Check whether ring is attached
+        bool
+        is_open(void)
+        {
+            return hdr != nullptr;
+        }
+        // Put value, blocks while the ring is full.
+        // The value is visible to consumer after
+        // SHM_BATCH values or flush().
+        //
+        // return 0 on success, -1 on fault or if
+        // consumer is gone
+        int         push(const scalar &val);
+        // Put values and publish them, blocks
+        // while the ring is full.
+        //
+        // arg[in] vals Scalar values
+        // arg[in] n    Number of values
+        //
+        // return 0 on success, -1 on fault or if
+        // consumer is gone
+        int         put(const scalar *vals, size_t n);
+        // Publish staged values
+        void        flush(void);
+        // Mark the end of values, consumer gets
+        // the rest of values and the end then
+        void        finish(void);
+        // Get value, blocks while the ring is empty
+        //
+        // return 0 on success, -1 at the end of values
+        int         pop(scalar &val);
+        // Get available values, blocks while the ring
+        // is empty.
+        //
+        // arg[out] vals    Scalar values
+        // arg[in]  n       Maximal number of values
+        //
+        // return number of values got, 0 at the end of values
+        size_t      get(scalar *vals, size_t n);
+} shm_ring;
+
+#endif //HAVE_CONSOLEIO_SHM_H
@@ -0,0 +1,258 @@
+#include "consoleio_sort.h"
+#include <vector>
+#include <thread>
+#include <memory>
+#include <cstring>
+
+//////////////////////////////////////////////////////
+// Module global namespace                          //
+//////////////////////////////////////////////////////
+using namespace std;
+
+//////////////////////////////////////////////////////
+// Module global macros                             //
+//////////////////////////////////////////////////////
+// Number of bits sorted by one pass
+#define RADIX_BITS  8
+
+// Number of buckets of one pass
+#define RADIX_N     (1 << RADIX_BITS)
+
+// Maximal number of passes
+#define PASSES_MAX  (64 / RADIX_BITS)
+
+//////////////////////////////////////////////////////
+// Module global functions                          //
+//////////////////////////////////////////////////////
+
+// Run function in several threads, the calling
+// thread runs function with index 0.
+//
+// arg[in] threads  Number of threads
+// arg[in] fn       Function taking thread index
+template <typename F>
+static void
+run_threads(int threads, F fn)
+{
+    vector<thread> workers;
+
+    for (int t = 1; t < threads; t++)
+        workers.emplace_back(fn, t);
+    fn(0);
+    for (auto &w : workers)
+        w.join();
+}
+
+// Sort order keys by one thread. Histograms of all
+// passes are counted with a single read of keys.
+//
+// arg[in,out] keys     Order keys
+// arg[in]     tmp      Temporary array of 'n' keys
+// arg[in]     n        Number of keys
+// arg[in]     passes   Number of passes
+static void
+sort_serial(uint64_t *keys, uint64_t *tmp, size_t n, int passes)
+{
+    size_t      cnt[PASSES_MAX][RADIX_N];
+    uint64_t   *src     = keys;
+    uint64_t   *dst     = tmp;
+
+    memset(cnt, 0, sizeof(cnt));
+    for (size_t i = 0; i < n; i++)
+    {
+        uint64_t key = keys[i];
+
+        for (int p = 0; p < passes; p++)
+            cnt[p][(key >> (p * RADIX_BITS)) & (RADIX_N - 1)]++;
+    }
+
+    for (int p = 0; p < passes; p++)
+    {
+        int     shift   = p * RADIX_BITS;
+        size_t  off     = 0;
+        bool    skip    = false;
+
+        for (int d = 0; d < RADIX_N; d++)
+        {
+            size_t c = cnt[p][d];
+
+            skip |= c == n;
+            cnt[p][d] = off;
+            off += c;
+        }
+        if (skip)
+            continue;
+
+        for (size_t i = 0; i < n; i++)
+        {
+            uint64_t key = src[i];
+
+            dst[cnt[p][(key >> shift) & (RADIX_N - 1)]++] = key;
+        }
+        swap(src, dst);
+    }
+
+    if (src != keys)
+        memcpy(keys, src, n * sizeof(*keys));
+}
+
+// Sort order keys by several threads. Each pass counts
+// histograms of array chunks in parallel, bucket offsets
+// of each chunk are got from all histograms, then chunks
+// are scattered in parallel.
+//
+// arg[in,out] keys     Order keys
+// arg[in]     tmp      Temporary array of 'n' keys
+// arg[in]     n        Number of keys
+// arg[in]     passes   Number of passes
+// arg[in]     threads  Number of threads
+static void
+sort_parallel(uint64_t *keys, uint64_t *tmp, size_t n, int passes,
+              int threads)
+{
+    vector<size_t>  cnt((size_t)threads * RADIX_N);
+    uint64_t       *src     = keys;
+    uint64_t       *dst     = tmp;
+
+    for (int p = 0; p < passes; p++)
+    {
+        int     shift   = p * RADIX_BITS;
+        size_t  off     = 0;
+        bool    skip    = false;
+
+        run_threads(threads, [&](int t)
+        {
+            size_t *c   = &cnt[(size_t)t * RADIX_N];
+            size_t  beg = n * t / threads;
+            size_t  end = n * (t + 1) / threads;
+
+            memset(c, 0, RADIX_N * sizeof(*c));
+            for (size_t i = beg; i < end; i++)
+                c[(src[i] >> shift) & (RADIX_N - 1)]++;
+        });
+
+        for (int d = 0; d < RADIX_N; d++)
+        {
+            size_t total = 0;
+
+            for (int t = 0; t < threads; t++)
+            {
+                size_t c = cnt[(size_t)t * RADIX_N + d];
+
+                cnt[(size_t)t * RADIX_N + d] = off;
+                off += c;
+                total += c;
+            }
+            skip |= total == n;
+        }
+        if (skip)
+            continue;
+
+        run_threads(threads, [&](int t)
+        {
+            size_t *c   = &cnt[(size_t)t * RADIX_N];
+            size_t  beg = n * t / threads;
+            size_t  end = n * (t + 1) / threads;
+
+            for (size_t i = beg; i < end; i++)
+            {
+                uint64_t key = src[i];
+
+                dst[c[(key >> shift) & (RADIX_N - 1)]++] = key;
+            }
+        });
+        swap(src, dst);
+    }
+
+    if (src != keys)
+        memcpy(keys, src, n * sizeof(*keys));
+}
+
+//////////////////////////////////////////////////////
+// Sort operations,                                 //
+// see definitions in consoleio_sort.h              //
+//////////////////////////////////////////////////////
+
+// Sort array of integer values in raw form. Values are
+// turned into order keys of the type size first: the
+// sign bit of signed types is inverted, so negative values
+// go before positive ones.
+long long
+radix_sort(uint64_t *vals, size_t n, scalar_t type, bool unique, int threads)
+{
+    int                     bits    = scalar_bits(type);
+    uint64_t                mask;
+    uint64_t                flip;
+    unique_ptr<uint64_t[]>  tmp;
+    size_t                  m;
+
+    if (bits < 0 || (vals == nullptr && n != 0))
+    {
+        cerr << "radix_sort(): Scalar value type is invalid." << endl;
+        return -1;
+    }
+
+    if (n < 2)
+        return (long long)n;
+
+    mask = bits >= 64 ? ~(uint64_t)0 : ((uint64_t)1 << bits) - 1;
+    flip = scalar_is_signed(type) ? (uint64_t)1 << (bits - 1) : 0;
+    tmp.reset(new uint64_t[n]);
+
+    if ((size_t)threads > n / SORT_THREAD_MIN)
+        threads = (int)(n / SORT_THREAD_MIN);
+
+    if (threads <= 1)
+    {
+        for (size_t i = 0; i < n; i++)
+            vals[i] = (vals[i] & mask) ^ flip;
+        sort_serial(vals, tmp.get(), n, bits / RADIX_BITS);
+        for (size_t i = 0; i < n; i++)
+            vals[i] = raw_cast(vals[i] ^ flip, type);
+    }
+    else
+    {
+        run_threads(threads, [&](int t)
+        {
+            for (size_t i = n * t / threads; i < n * (t + 1) / threads; i++)
+                vals[i] = (vals[i] & mask) ^ flip;
+        });
+        sort_parallel(vals, tmp.get(), n, bits / RADIX_BITS, threads);
+        run_threads(threads, [&](int t)
+        {
+            for (size_t i = n * t / threads; i < n * (t + 1) / threads; i++)
+                vals[i] = raw_cast(vals[i] ^ flip, type);
+        });
+    }
+
+    if (!unique)
+        return (long long)n;
+
+    m = 1;
+    for (size_t i = 1; i < n; i++)
+    {
+        if (vals[i] != vals[m - 1])
+            vals[m++] = vals[i];
+    }
+
+    return (long long)m;
+}
+
+//////////////////////////////////////////////////////
+// Class stream sort operations,                    //
+// see definitions in consoleio.h                   //
+//////////////////////////////////////////////////////
+
+// Sort array of integer values and put them onto
+// output stream
+int
+stream::put_sorted(uint64_t *vals, size_t n, scalar_t type, base_t base,
+                   bool unique, int threads, char sep)
+{
+    long long m = radix_sort(vals, n, type, unique, threads);
+
+    if (m < 0)
+        return -1;
+
+    return put_array(vals, (size_t)m, type, base, sep);
+}
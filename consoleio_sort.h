@@ -0,0 +1,40 @@
+//////////////////////////////////////////////////////////////
+// Sorting of integer values in raw form:                   //
+// LSD radix sort ordering values by their scalar type,     //
+// single and multithreaded, with optional deduplication.   //
+//////////////////////////////////////////////////////////////
+#ifndef HAVE_CONSOLEIO_SORT_H
+#define HAVE_CONSOLEIO_SORT_H
+#include "consoleio.h"
+
+//////////////////////////////////////////////////////////////
+// Global library defines                                   //
+//////////////////////////////////////////////////////////////
+
+// Minimal number of values sorted by each thread,
+// smaller arrays are sorted by the calling thread
+#define SORT_THREAD_MIN (1 << 16)
+
+//////////////////////////////////////////////////////////////
+// Sort operations                                          //
+//////////////////////////////////////////////////////////////
+
+// Sort array of integer values in raw form in ascending
+// order of given scalar type. Values are sorted by bytes
+// of the type size from the least significant one, signed
+// values are ordered with inverted sign bit. Passes over
+// bytes equal in all values are skipped.
+//
+// arg[in,out] vals     Raw integer values, values are cast
+//                      to scalar type (see raw_cast())
+// arg[in]     n        Number of values
+// arg[in]     type     Scalar value type
+// arg[in]     unique   Whether duplicates are removed
+// arg[in]     threads  Number of threads
+//
+// return number of sorted values on success
+// (less than 'n' if duplicates are removed), -1 on fault
+long long   radix_sort(uint64_t *vals, size_t n, scalar_t type,
+                       bool unique = false, int threads = 1);
+
+#endif //HAVE_CONSOLEIO_SORT_H